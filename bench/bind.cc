@@ -0,0 +1,290 @@
+#include <benchmark/benchmark.h>
+#include "corpus.hpp"
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <vector>
+
+using namespace saxy_json;
+
+namespace timeline
+{
+struct User
+{
+    std::int64_t id = 0;
+    std::string name;
+    std::string screen_name;
+    std::int64_t followers_count = 0;
+    std::int64_t friends_count = 0;
+    bool verified = false;
+};
+SAXY_JSON_FIELDS(User, id, name, screen_name, followers_count, friends_count, verified)
+
+struct Hashtag
+{
+    std::string text;
+    std::vector<int> indices;
+};
+SAXY_JSON_FIELDS(Hashtag, text, indices)
+
+struct Entities
+{
+    std::vector<Hashtag> hashtags;
+};
+SAXY_JSON_FIELDS(Entities, hashtags)
+
+struct Status
+{
+    std::string created_at;
+    std::int64_t id = 0;
+    std::string text;
+    bool truncated = false;
+    std::optional<std::int64_t> in_reply_to_status_id;
+    User user;
+    std::int64_t retweet_count = 0;
+    std::int64_t favorite_count = 0;
+    Entities entities;
+};
+SAXY_JSON_FIELDS(
+    Status, created_at, id, text, truncated, in_reply_to_status_id, user, retweet_count,
+    favorite_count, entities)
+
+struct Timeline
+{
+    std::vector<Status> statuses;
+};
+SAXY_JSON_FIELDS(Timeline, statuses)
+
+/// What ParseInto replaces: a handler tracking its position in the document
+/// by depth and comparing every key against the fields at that position
+class Handler
+{
+public:
+    explicit Handler(Timeline& timeline)
+        : timeline(timeline)
+    {}
+
+    void StartObject()
+    {
+        ++depth;
+        if (depth == 3)
+            timeline.statuses.emplace_back();
+        else if (depth == 4)
+            object = field;
+        else if (depth == 6)
+            Current().entities.hashtags.emplace_back();
+    }
+    void FinishObject() { --depth; }
+    void StartArray()
+    {
+        ++depth;
+        if (field == Field::Indices)
+            Current().entities.hashtags.back().indices.clear();
+    }
+    void FinishArray()
+    {
+        --depth;
+        field = Field::Other;
+    }
+    Control Key(std::string_view key)
+    {
+        field = Field::Other;
+        if (depth == 1 && key == "statuses")
+        {
+            field = Field::Statuses;
+        }
+        else if (depth == 3)
+        {
+            static constexpr std::pair<std::string_view, Field> fields[] = {
+                {"created_at", Field::CreatedAt}, {"id", Field::Id},
+                {"text", Field::Text}, {"truncated", Field::Truncated},
+                {"in_reply_to_status_id", Field::InReplyTo}, {"user", Field::User},
+                {"retweet_count", Field::RetweetCount},
+                {"favorite_count", Field::FavoriteCount}, {"entities", Field::Entities}};
+            field = Find(fields, key);
+        }
+        else if (depth == 4 && object == Field::User)
+        {
+            static constexpr std::pair<std::string_view, Field> fields[] = {
+                {"id", Field::UserId}, {"name", Field::Name},
+                {"screen_name", Field::ScreenName}, {"followers_count", Field::Followers},
+                {"friends_count", Field::Friends}, {"verified", Field::Verified}};
+            field = Find(fields, key);
+        }
+        else if (depth == 4 && object == Field::Entities && key == "hashtags")
+        {
+            field = Field::Hashtags;
+        }
+        else if (depth == 6)
+        {
+            field = key == "text" ? Field::HashtagText
+                : key == "indices" ? Field::Indices
+                                   : Field::Other;
+        }
+        return field == Field::Other ? Control::Skip : Control::Continue;
+    }
+    void String(std::string_view str)
+    {
+        auto& status = Current();
+        switch (field)
+        {
+        case Field::CreatedAt: status.created_at = str; break;
+        case Field::Text: status.text = str; break;
+        case Field::Name: status.user.name = str; break;
+        case Field::ScreenName: status.user.screen_name = str; break;
+        case Field::HashtagText: status.entities.hashtags.back().text = str; break;
+        default: break;
+        }
+    }
+    void Int(std::intmax_t i)
+    {
+        auto& status = Current();
+        switch (field)
+        {
+        case Field::Id: status.id = i; break;
+        case Field::InReplyTo: status.in_reply_to_status_id = i; break;
+        case Field::RetweetCount: status.retweet_count = i; break;
+        case Field::FavoriteCount: status.favorite_count = i; break;
+        case Field::UserId: status.user.id = i; break;
+        case Field::Followers: status.user.followers_count = i; break;
+        case Field::Friends: status.user.friends_count = i; break;
+        case Field::Indices:
+            status.entities.hashtags.back().indices.push_back(static_cast<int>(i));
+            break;
+        default: break;
+        }
+    }
+    void Float(double) {}
+    void Bool(bool b)
+    {
+        if (field == Field::Truncated)
+            Current().truncated = b;
+        else if (field == Field::Verified)
+            Current().user.verified = b;
+    }
+    void Null()
+    {
+        if (field == Field::InReplyTo)
+            Current().in_reply_to_status_id.reset();
+    }
+
+private:
+    enum class Field
+    {
+        Other,
+        Statuses,
+        CreatedAt,
+        Id,
+        Text,
+        Truncated,
+        InReplyTo,
+        User,
+        RetweetCount,
+        FavoriteCount,
+        Entities,
+        UserId,
+        Name,
+        ScreenName,
+        Followers,
+        Friends,
+        Verified,
+        Hashtags,
+        HashtagText,
+        Indices,
+    };
+
+    template<std::size_t N>
+    static Field Find(const std::pair<std::string_view, Field> (&fields)[N], std::string_view key)
+    {
+        auto found = std::find_if(
+            std::begin(fields), std::end(fields), [&](const auto& f) { return f.first == key; });
+        return found != std::end(fields) ? found->second : Field::Other;
+    }
+
+    Status& Current() { return timeline.statuses.back(); }
+
+    Timeline& timeline;
+    int depth = 0;
+    Field field = Field::Other;
+    /// The field of the open object at depth 4
+    Field object = Field::Other;
+};
+} // namespace timeline
+
+namespace geo
+{
+struct Geometry
+{
+    std::string type;
+    std::vector<std::vector<std::vector<double>>> coordinates;
+};
+SAXY_JSON_FIELDS(Geometry, type, coordinates)
+
+struct Feature
+{
+    std::string type;
+    Geometry geometry;
+};
+SAXY_JSON_FIELDS(Feature, type, geometry)
+
+struct FeatureCollection
+{
+    std::string type;
+    std::vector<Feature> features;
+};
+SAXY_JSON_FIELDS(FeatureCollection, type, features)
+} // namespace geo
+
+static const corpus::Document& Find(std::string_view name)
+{
+    const auto& documents = corpus::Documents();
+    return *std::find_if(documents.begin(), documents.end(), [&](const auto& document) {
+        return document.name == name;
+    });
+}
+
+template<typename T>
+static void BM_ParseInto(benchmark::State& state, std::string_view name)
+{
+    const auto& json = Find(name).json;
+    for (auto _ : state)
+    {
+        T value;
+        if (!ParseInto(value, json))
+        {
+            state.SkipWithError("document failed to parse");
+            break;
+        }
+        benchmark::DoNotOptimize(&value);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(json.size()));
+}
+
+static void BM_ParseHandWritten(benchmark::State& state)
+{
+    const auto& json = Find("twitter").json;
+    for (auto _ : state)
+    {
+        timeline::Timeline timeline;
+        timeline::Handler handler{timeline};
+        if (!Parse(handler, json))
+        {
+            state.SkipWithError("document failed to parse");
+            break;
+        }
+        benchmark::DoNotOptimize(timeline.statuses.data());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(json.size()));
+}
+
+static const bool registered = [] {
+    benchmark::RegisterBenchmark(
+        "BM_ParseInto/twitter", BM_ParseInto<timeline::Timeline>, "twitter")
+        ->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark("BM_ParseHandWritten/twitter", BM_ParseHandWritten)
+        ->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark(
+        "BM_ParseInto/canada", BM_ParseInto<geo::FeatureCollection>, "canada")
+        ->Unit(benchmark::kMillisecond);
+    return true;
+}();
@@ -0,0 +1,350 @@
+#ifndef INCLUDED_SAXY_JSON_BENCH_CORPUS_HPP
+#define INCLUDED_SAXY_JSON_BENCH_CORPUS_HPP
+
+#include "../include/saxy-json.hpp"
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace corpus
+{
+/// Counts the events of a parse, for events/s
+class CountingHandler
+{
+public:
+    void StartObject() { ++events; }
+    void FinishObject() { ++events; }
+    void StartArray() { ++events; }
+    void FinishArray() { ++events; }
+    void Key(std::string_view) { ++events; }
+    void String(std::string_view) { ++events; }
+    void Int(std::intmax_t) { ++events; }
+    void Float(double) { ++events; }
+    void Bool(bool) { ++events; }
+    void Null() { ++events; }
+    void Error(std::string&&) { ++errors; }
+
+    std::size_t events = 0;
+    std::size_t errors = 0;
+};
+
+/// Deterministic pseudo-random numbers, identical on every platform so the
+/// documents are the same wherever the benchmarks run
+class Random
+{
+public:
+    std::uint64_t Next()
+    {
+        state = state * 6364136223846793005u + 1442695040888963407u;
+        return state >> 33;
+    }
+    std::intmax_t Int(std::intmax_t min, std::intmax_t max)
+    {
+        return min
+            + static_cast<std::intmax_t>(
+                   Next() % static_cast<std::uint64_t>(max - min + 1));
+    }
+    /// A float in [min, max] with `decimals` digits after the point
+    double Float(double min, double max, int decimals)
+    {
+        auto scale = std::pow(10.0, decimals);
+        auto value = min
+            + (max - min) * static_cast<double>(Next() % 1000000007) / 1000000007.0;
+        return std::round(value * scale) / scale;
+    }
+    bool Chance(int percent) { return Int(0, 99) < percent; }
+
+private:
+    std::uint64_t state = 0x5eed;
+};
+
+/// Text with mostly ASCII words, and occasionally quotes, control characters
+/// and multibyte UTF-8 that the writer escapes or passes through
+inline std::string Text(Random& random, int words)
+{
+    static constexpr std::string_view vocabulary[] = {
+        "the", "json", "parser", "event", "stream", "buffer", "value",
+        "quick", "brown", "fox", "\"quoted\"", "line\nbreak", "tab\there",
+        "caf\xc3\xa9", "\xe6\x97\xa5\xe6\x9c\xac", "\xf0\x9f\x98\x80",
+        "back\\slash", "https://example.com/path?q=1",
+    };
+    std::string text;
+    for (int i = 0; i < words; ++i)
+    {
+        if (i != 0)
+            text += ' ';
+        text += vocabulary[random.Next() % std::size(vocabulary)];
+    }
+    return text;
+}
+
+/// Arrays of integers and floats of all magnitudes
+template<typename TWriter>
+void Numbers(TWriter& writer, std::size_t size)
+{
+    Random random;
+    writer.StartArray();
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        writer.StartArray();
+        for (int j = 0; j < 16; ++j)
+        {
+            if (random.Chance(50))
+                writer.Int(random.Int(-1000000000000, 1000000000000) >> random.Int(0, 40));
+            else
+                writer.Float(random.Float(-1e6, 1e6, static_cast<int>(random.Int(0, 9))));
+        }
+        writer.FinishArray();
+    }
+    writer.FinishArray();
+}
+
+/// Long and short strings, some with escapes and UTF-8
+template<typename TWriter>
+void Strings(TWriter& writer, std::size_t size)
+{
+    Random random;
+    writer.StartArray();
+    for (std::size_t i = 0; i < size; ++i)
+        writer.String(Text(random, static_cast<int>(random.Int(1, 60))));
+    writer.FinishArray();
+}
+
+/// Objects and arrays nested hundreds of levels deep, with few values
+template<typename TWriter>
+void Nested(TWriter& writer, std::size_t size)
+{
+    constexpr int depth = 400;
+    writer.StartArray();
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        for (int level = 0; level < depth; ++level)
+        {
+            if (level % 2 == 0)
+            {
+                writer.StartObject();
+                writer.Key("k");
+            }
+            else
+            {
+                writer.StartArray();
+            }
+        }
+        writer.Int(static_cast<std::intmax_t>(i));
+        for (int level = depth - 1; level >= 0; --level)
+        {
+            if (level % 2 == 0)
+                writer.FinishObject();
+            else
+                writer.FinishArray();
+        }
+    }
+    writer.FinishArray();
+}
+
+/// Social media statuses like twitter.json: many keys, nested user objects,
+/// text with escapes and UTF-8, nulls and booleans
+template<typename TWriter>
+void Twitter(TWriter& writer, std::size_t size)
+{
+    Random random;
+    writer.StartObject();
+    writer.Key("statuses");
+    writer.StartArray();
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        auto id = 505874924095815681 + static_cast<std::intmax_t>(i);
+        writer.StartObject();
+        writer.KeyValue("created_at", "Sun Aug 31 00:29:15 +0000 2014");
+        writer.KeyValue("id", id);
+        writer.KeyValue("id_str", std::to_string(id));
+        writer.KeyValue("text", Text(random, static_cast<int>(random.Int(3, 25))));
+        writer.KeyValue("source", "<a href=\"http://example.com\" rel=\"nofollow\">client</a>");
+        writer.KeyValue("truncated", false);
+        writer.KeyValue("in_reply_to_status_id", nullptr);
+        writer.Key("user");
+        writer.StartObject();
+        writer.KeyValue("id", random.Int(1, 3000000000));
+        writer.KeyValue("name", Text(random, 2));
+        writer.KeyValue("screen_name", "user" + std::to_string(random.Int(0, 9999)));
+        writer.KeyValue("location", random.Chance(50) ? "Tokyo" : "");
+        writer.KeyValue("description", Text(random, static_cast<int>(random.Int(0, 20))));
+        writer.KeyValue("followers_count", random.Int(0, 100000));
+        writer.KeyValue("friends_count", random.Int(0, 5000));
+        writer.KeyValue("verified", random.Chance(5));
+        writer.KeyValue("profile_background_color", "C0DEED");
+        writer.FinishObject();
+        writer.KeyValue("geo", nullptr);
+        writer.KeyValue("retweet_count", random.Int(0, 1000));
+        writer.KeyValue("favorite_count", random.Int(0, 1000));
+        writer.Key("entities");
+        writer.StartObject();
+        writer.Key("hashtags");
+        writer.StartArray();
+        for (auto n = random.Int(0, 3); n > 0; --n)
+        {
+            writer.StartObject();
+            writer.KeyValue("text", Text(random, 1));
+            writer.Key("indices");
+            writer.StartArray();
+            writer.Int(random.Int(0, 70));
+            writer.Int(random.Int(70, 140));
+            writer.FinishArray();
+            writer.FinishObject();
+        }
+        writer.FinishArray();
+        writer.Key("urls");
+        writer.StartArray();
+        writer.FinishArray();
+        writer.FinishObject();
+        writer.KeyValue("favorited", false);
+        writer.KeyValue("lang", "ja");
+        writer.FinishObject();
+    }
+    writer.FinishArray();
+    writer.FinishObject();
+}
+
+/// Event listings like citm_catalog.json: objects keyed by numeric ids,
+/// arrays of small integers and many nulls
+template<typename TWriter>
+void Citm(TWriter& writer, std::size_t size)
+{
+    Random random;
+    writer.StartObject();
+    writer.Key("events");
+    writer.StartObject();
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        auto id = 138586341 + static_cast<std::intmax_t>(i);
+        writer.Key(std::to_string(id));
+        writer.StartObject();
+        writer.KeyValue("description", nullptr);
+        writer.KeyValue("id", id);
+        writer.KeyValue("logo", random.Chance(30) ? "/images/UE0AAAAACEKo6QAAAAZDSVRN" : "");
+        writer.KeyValue("name", Text(random, 3));
+        writer.Key("subTopicIds");
+        writer.StartArray();
+        for (auto n = random.Int(1, 6); n > 0; --n)
+            writer.Int(337184262 + random.Int(0, 100));
+        writer.FinishArray();
+        writer.KeyValue("subjectCode", nullptr);
+        writer.KeyValue("subtitle", nullptr);
+        writer.Key("topicIds");
+        writer.StartArray();
+        writer.Int(324846099);
+        writer.Int(107888604);
+        writer.FinishArray();
+        writer.FinishObject();
+    }
+    writer.FinishObject();
+    writer.Key("performances");
+    writer.StartArray();
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        writer.StartObject();
+        writer.KeyValue("eventId", 138586341 + static_cast<std::intmax_t>(i));
+        writer.KeyValue("id", 339887544 + static_cast<std::intmax_t>(i));
+        writer.KeyValue("logo", nullptr);
+        writer.KeyValue("name", nullptr);
+        writer.Key("prices");
+        writer.StartArray();
+        for (auto n = random.Int(1, 4); n > 0; --n)
+        {
+            writer.StartObject();
+            writer.KeyValue("amount", random.Int(9000, 180000));
+            writer.KeyValue("audienceSubCategoryId", 337100890);
+            writer.KeyValue("seatCategoryId", 338937295 + random.Int(0, 10));
+            writer.FinishObject();
+        }
+        writer.FinishArray();
+        writer.KeyValue("seatMapImage", nullptr);
+        writer.KeyValue("start", 1372701600000 + random.Int(0, 100000000));
+        writer.KeyValue("venueCode", "PLEYEL_PLEYEL");
+        writer.FinishObject();
+    }
+    writer.FinishArray();
+    writer.FinishObject();
+}
+
+/// A GeoJSON polygon like canada.json: long arrays of coordinate pairs with
+/// full-precision floats
+template<typename TWriter>
+void Canada(TWriter& writer, std::size_t size)
+{
+    Random random;
+    writer.StartObject();
+    writer.KeyValue("type", "FeatureCollection");
+    writer.Key("features");
+    writer.StartArray();
+    writer.StartObject();
+    writer.KeyValue("type", "Feature");
+    writer.Key("properties");
+    writer.StartObject();
+    writer.KeyValue("name", "Canada");
+    writer.FinishObject();
+    writer.Key("geometry");
+    writer.StartObject();
+    writer.KeyValue("type", "Polygon");
+    writer.Key("coordinates");
+    writer.StartArray();
+    for (std::size_t ring = 0; ring < size; ++ring)
+    {
+        writer.StartArray();
+        for (int point = 0; point < 100; ++point)
+        {
+            writer.StartArray();
+            writer.Float(random.Float(-141.0, -52.0, 12));
+            writer.Float(random.Float(41.0, 83.0, 12));
+            writer.FinishArray();
+        }
+        writer.FinishArray();
+    }
+    writer.FinishArray();
+    writer.FinishObject();
+    writer.FinishObject();
+    writer.FinishArray();
+    writer.FinishObject();
+}
+
+struct Document
+{
+    std::string_view name;
+    std::string json;
+};
+
+/// The documents all benchmarks run on, each a few megabytes in size
+inline const std::vector<Document>& Documents()
+{
+    static const std::vector<Document> documents = [] {
+        auto write = [](auto&& generate) {
+            std::string json;
+            {
+                saxy_json::Writer<std::string> writer(json);
+                generate(writer);
+            }
+            return json;
+        };
+        std::vector<Document> documents;
+        documents.push_back({"numbers", write([](auto& w) { Numbers(w, 20000); })});
+        documents.push_back({"strings", write([](auto& w) { Strings(w, 20000); })});
+        documents.push_back({"nested", write([](auto& w) { Nested(w, 1000); })});
+        documents.push_back({"twitter", write([](auto& w) { Twitter(w, 5000); })});
+        documents.push_back({"citm", write([](auto& w) { Citm(w, 10000); })});
+        documents.push_back({"canada", write([](auto& w) { Canada(w, 500); })});
+
+        std::string pretty;
+        {
+            saxy_json::PrettyWriter<std::string> writer(pretty);
+            Twitter(writer, 5000);
+        }
+        documents.push_back({"pretty", std::move(pretty)});
+        return documents;
+    }();
+    return documents;
+}
+} // namespace corpus
+
+#endif
@@ -0,0 +1,67 @@
+#include <benchmark/benchmark.h>
+#include "corpus.hpp"
+#include <string>
+
+using namespace saxy_json;
+
+using corpus::CountingHandler;
+
+static const std::string& Lines()
+{
+    static const std::string lines = [] {
+        std::string lines;
+        for (int i = 0; lines.size() < (std::size_t{64} << 20); ++i)
+        {
+            lines += R"({"id": )" + std::to_string(i)
+                + R"(, "ts": 1700000000.25, "user": {"name": "user)"
+                + std::to_string(i % 1000)
+                + R"(", "active": true}, "values": [1, 2, 3, 4.5], "note": null})"
+                + "\n";
+        }
+        return lines;
+    }();
+    return lines;
+}
+
+static void BM_ParseLines(benchmark::State& state)
+{
+    const auto& lines = Lines();
+    for (auto _ : state)
+    {
+        CountingHandler handler;
+        ParseLines(handler, lines);
+        benchmark::DoNotOptimize(handler.events);
+    }
+    state.SetBytesProcessed(
+        state.iterations() * static_cast<std::int64_t>(Lines().size()));
+}
+
+static void BM_ParseLinesParallel(benchmark::State& state)
+{
+    const auto& lines = Lines();
+    ParallelOptions options;
+    options.threads = static_cast<std::size_t>(state.range(0));
+    options.delivery =
+        state.range(1) != 0 ? Delivery::Ordered : Delivery::Unordered;
+
+    for (auto _ : state)
+    {
+        std::size_t events = 0;
+        ParseLinesParallel(
+            CountingHandler{}, lines,
+            [&events](CountingHandler&& handler, std::size_t) {
+                events += handler.events;
+            },
+            options);
+        benchmark::DoNotOptimize(events);
+    }
+    state.SetBytesProcessed(
+        state.iterations() * static_cast<std::int64_t>(Lines().size()));
+}
+
+BENCHMARK(BM_ParseLines)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ParseLinesParallel)
+    ->ArgNames({"threads", "ordered"})
+    ->ArgsProduct({{1, 2, 4, 8, 16, 32}, {1, 0}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
@@ -0,0 +1,73 @@
+#include <benchmark/benchmark.h>
+#include "corpus.hpp"
+#include <sstream>
+#include <string>
+
+using namespace saxy_json;
+
+/// Reports the input throughput and the handler events per second
+static void SetCounters(
+    benchmark::State& state, const corpus::Document& document, std::size_t events)
+{
+    state.SetBytesProcessed(
+        state.iterations() * static_cast<std::int64_t>(document.json.size()));
+    state.counters["events"] = benchmark::Counter(
+        static_cast<double>(events), benchmark::Counter::kIsIterationInvariantRate);
+    state.counters["bytes"] = static_cast<double>(document.json.size());
+}
+
+/// Parses an in-memory document, registered once per set of options
+static void BM_Parse(
+    benchmark::State& state, const corpus::Document* document, ParseOptions options)
+{
+    std::size_t events = 0;
+    for (auto _ : state)
+    {
+        corpus::CountingHandler handler;
+        if (!Parse(handler, document->json, options))
+        {
+            state.SkipWithError("document failed to parse");
+            break;
+        }
+        events = handler.events;
+    }
+    SetCounters(state, *document, events);
+}
+
+static void BM_ParseStream(benchmark::State& state, const corpus::Document* document)
+{
+    std::size_t events = 0;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        std::istringstream stream(document->json);
+        state.ResumeTiming();
+
+        corpus::CountingHandler handler;
+        if (!Parse(handler, stream))
+        {
+            state.SkipWithError("document failed to parse");
+            break;
+        }
+        events = handler.events;
+    }
+    SetCounters(state, *document, events);
+}
+
+static const bool registered = [] {
+    for (const auto& document : corpus::Documents())
+    {
+        auto name = std::string(document.name);
+        benchmark::RegisterBenchmark(
+            ("BM_Parse/" + name).c_str(), BM_Parse, &document, ParseOptions{})
+            ->Unit(benchmark::kMillisecond);
+        benchmark::RegisterBenchmark(
+            ("BM_ParseValidated/" + name).c_str(), BM_Parse, &document,
+            ParseOptions{.validate_utf8 = true})
+            ->Unit(benchmark::kMillisecond);
+        benchmark::RegisterBenchmark(
+            ("BM_ParseStream/" + name).c_str(), BM_ParseStream, &document)
+            ->Unit(benchmark::kMillisecond);
+    }
+    return true;
+}();
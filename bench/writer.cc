@@ -0,0 +1,219 @@
+#include <benchmark/benchmark.h>
+#include "corpus.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace saxy_json;
+
+/// Mirrors the previous Writer API, where the structural calls were virtual
+/// and PrettyWriter overrode them
+class VirtualWriter
+{
+public:
+    virtual ~VirtualWriter() = default;
+
+    virtual void StartObject() = 0;
+    virtual void FinishObject() = 0;
+    virtual void StartArray() = 0;
+    virtual void FinishArray() = 0;
+    virtual void Key(std::string_view key) = 0;
+    virtual void String(std::string_view str) = 0;
+    virtual void Int(std::intmax_t i) = 0;
+
+    void KeyValue(std::string_view key, std::intmax_t value)
+    {
+        Key(key);
+        Int(value);
+    }
+    void KeyValue(std::string_view key, std::string_view value)
+    {
+        Key(key);
+        String(value);
+    }
+};
+
+template<typename TWriter>
+class VirtualAdapter : public VirtualWriter
+{
+public:
+    explicit VirtualAdapter(std::string& out)
+        : writer(out)
+    {}
+
+    void StartObject() override { writer.StartObject(); }
+    void FinishObject() override { writer.FinishObject(); }
+    void StartArray() override { writer.StartArray(); }
+    void FinishArray() override { writer.FinishArray(); }
+    void Key(std::string_view key) override { writer.Key(key); }
+    void String(std::string_view str) override { writer.String(str); }
+    void Int(std::intmax_t i) override { writer.Int(i); }
+
+private:
+    TWriter writer;
+};
+
+template<typename TWriter>
+static void WriteRecords(TWriter& writer)
+{
+    writer.StartArray();
+    for (std::intmax_t i = 0; i < 1000; ++i)
+    {
+        writer.StartObject();
+        writer.KeyValue("id", i);
+        writer.KeyValue("name", "record");
+        writer.Key("tags");
+        writer.StartArray();
+        writer.String("a");
+        writer.String("b");
+        writer.FinishArray();
+        writer.FinishObject();
+    }
+    writer.FinishArray();
+}
+
+template<typename TWriter>
+static void BM_StaticDispatch(benchmark::State& state)
+{
+    std::string out;
+    for (auto _ : state)
+    {
+        out.clear();
+        TWriter writer{out};
+        WriteRecords(writer);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(
+        state.iterations() * static_cast<std::int64_t>(out.size()));
+}
+
+template<typename TWriter>
+static void BM_VirtualDispatch(benchmark::State& state)
+{
+    std::string out;
+    for (auto _ : state)
+    {
+        out.clear();
+        std::unique_ptr<VirtualWriter> writer =
+            std::make_unique<VirtualAdapter<TWriter>>(out);
+        // Keep the compiler from devirtualising the calls
+        benchmark::DoNotOptimize(writer.get());
+        WriteRecords(*writer);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(
+        state.iterations() * static_cast<std::int64_t>(out.size()));
+}
+
+BENCHMARK(BM_StaticDispatch<Writer<std::string>>);
+BENCHMARK(BM_VirtualDispatch<Writer<std::string>>);
+BENCHMARK(BM_StaticDispatch<PrettyWriter<std::string>>);
+BENCHMARK(BM_VirtualDispatch<PrettyWriter<std::string>>);
+
+/// The events of a parsed corpus document, replayed into a writer so only
+/// the writer is measured
+class Recording
+{
+public:
+    enum class Kind
+    {
+        StartObject,
+        FinishObject,
+        StartArray,
+        FinishArray,
+        Key,
+        String,
+        Int,
+        Float,
+        Bool,
+        Null,
+    };
+
+    struct Event
+    {
+        Kind kind;
+        std::string text;
+        std::intmax_t i = 0;
+        double f = 0;
+    };
+
+    void StartObject() { events.push_back({Kind::StartObject, {}}); }
+    void FinishObject() { events.push_back({Kind::FinishObject, {}}); }
+    void StartArray() { events.push_back({Kind::StartArray, {}}); }
+    void FinishArray() { events.push_back({Kind::FinishArray, {}}); }
+    void Key(std::string_view key) { events.push_back({Kind::Key, std::string(key)}); }
+    void String(std::string_view str)
+    {
+        events.push_back({Kind::String, std::string(str)});
+    }
+    void Int(std::intmax_t i) { events.push_back({Kind::Int, {}, i}); }
+    void Float(double f) { events.push_back({Kind::Float, {}, 0, f}); }
+    void Bool(bool b) { events.push_back({Kind::Bool, {}, b}); }
+    void Null() { events.push_back({Kind::Null, {}}); }
+
+    template<typename TWriter>
+    void Replay(TWriter& writer) const
+    {
+        for (const auto& event : events)
+        {
+            switch (event.kind)
+            {
+                case Kind::StartObject: writer.StartObject(); break;
+                case Kind::FinishObject: writer.FinishObject(); break;
+                case Kind::StartArray: writer.StartArray(); break;
+                case Kind::FinishArray: writer.FinishArray(); break;
+                case Kind::Key: writer.Key(event.text); break;
+                case Kind::String: writer.String(event.text); break;
+                case Kind::Int: writer.Int(event.i); break;
+                case Kind::Float: writer.Float(event.f); break;
+                case Kind::Bool: writer.Bool(event.i != 0); break;
+                case Kind::Null: writer.Null(); break;
+            }
+        }
+    }
+
+    std::vector<Event> events;
+};
+
+template<typename TWriter>
+static void BM_Write(benchmark::State& state, const corpus::Document* document)
+{
+    Recording recording;
+    Parse(recording, document->json);
+
+    std::string out;
+    for (auto _ : state)
+    {
+        out.clear();
+        {
+            TWriter writer{out};
+            recording.Replay(writer);
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(
+        state.iterations() * static_cast<std::int64_t>(out.size()));
+    state.counters["events"] = benchmark::Counter(
+        static_cast<double>(recording.events.size()),
+        benchmark::Counter::kIsIterationInvariantRate);
+    state.counters["bytes"] = static_cast<double>(out.size());
+}
+
+static const bool registered = [] {
+    for (const auto& document : corpus::Documents())
+    {
+        auto name = std::string(document.name);
+        benchmark::RegisterBenchmark(
+            ("BM_Write<Writer>/" + name).c_str(), BM_Write<Writer<std::string>>,
+            &document)
+            ->Unit(benchmark::kMillisecond);
+        // Indenting 400 levels deep would write hundreds of megabytes
+        if (document.name == "nested")
+            continue;
+        benchmark::RegisterBenchmark(
+            ("BM_Write<PrettyWriter>/" + name).c_str(),
+            BM_Write<PrettyWriter<std::string>>, &document)
+            ->Unit(benchmark::kMillisecond);
+    }
+    return true;
+}();
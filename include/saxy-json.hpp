@@ -14,144 +14,543 @@
 #include <concepts>
 #include <charconv>
 #include <functional>
+#include <cstdio>
+#include <bit>
+#include <algorithm>
+#include <span>
+#include <ranges>
+#include <filesystem>
+#include <fstream>
+#include <cstring>
+#include <cerrno>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <optional>
+#include <stdexcept>
+#include <initializer_list>
+#include <type_traits>
+#include <tuple>
+#include <utility>
+#include <memory>
+#include <new>
+
+#if __has_include(<sys/mman.h>) && __has_include(<unistd.h>)
+#define SAXY_JSON_POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Define SAXY_JSON_SCALAR to disable the vectorised scanning kernels, e.g. to
+// compare results against the plain character-by-character implementation.
+#if !defined(SAXY_JSON_SCALAR) && defined(__AVX2__)
+#define SAXY_JSON_AVX2
+#include <immintrin.h>
+#elif !defined(SAXY_JSON_SCALAR) && defined(__SSE2__)
+#define SAXY_JSON_SSE2
+#include <emmintrin.h>
+#endif
 
 namespace saxy_json
 {
-template<typename OStream = std::ostream>
-class Writer
+namespace detail
 {
-public:
-    explicit Writer(OStream& ostream)
-        : ostream(ostream)
+constexpr bool IsWhitespace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+/// Characters that end a run of plain string content: '"', '\\' and the
+/// control characters that must be escaped.
+constexpr bool IsStringSpecial(char c)
+{
+    return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+}
+
+#if defined(SAXY_JSON_AVX2)
+using Vector = __m256i;
+constexpr std::size_t vector_size = 32;
+
+inline Vector Load(const char* pos)
+{
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos));
+}
+inline Vector Splat(char c) { return _mm256_set1_epi8(c); }
+inline Vector Equal(Vector a, Vector b) { return _mm256_cmpeq_epi8(a, b); }
+inline Vector Or(Vector a, Vector b) { return _mm256_or_si256(a, b); }
+/// Bytes that are <= c when compared as unsigned
+inline Vector LessEqual(Vector a, char c)
+{
+    return Equal(_mm256_max_epu8(a, Splat(c)), Splat(c));
+}
+inline std::uint32_t Mask(Vector v)
+{
+    return static_cast<std::uint32_t>(_mm256_movemask_epi8(v));
+}
+#elif defined(SAXY_JSON_SSE2)
+using Vector = __m128i;
+constexpr std::size_t vector_size = 16;
+
+inline Vector Load(const char* pos)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+}
+inline Vector Splat(char c) { return _mm_set1_epi8(c); }
+inline Vector Equal(Vector a, Vector b) { return _mm_cmpeq_epi8(a, b); }
+inline Vector Or(Vector a, Vector b) { return _mm_or_si128(a, b); }
+/// Bytes that are <= c when compared as unsigned
+inline Vector LessEqual(Vector a, char c)
+{
+    return Equal(_mm_max_epu8(a, Splat(c)), Splat(c));
+}
+inline std::uint32_t Mask(Vector v)
+{
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(v)) & 0xFFFF;
+}
+#endif
+
+/// Returns the first non-whitespace character in [pos, end), or `end`.
+inline const char* FindNonWhitespace(const char* pos, const char* end)
+{
+    // Compact input rarely has any whitespace, so check the first byte before
+    // setting up the vector loop
+    if (pos == end || !IsWhitespace(*pos))
+        return pos;
+
+#if defined(SAXY_JSON_AVX2) || defined(SAXY_JSON_SSE2)
+    constexpr std::uint32_t all = (std::uint64_t{1} << vector_size) - 1;
+    for (; static_cast<std::size_t>(end - pos) >= vector_size; pos += vector_size)
     {
-        level_stack.push_back(false);
+        auto v = Load(pos);
+        auto ws = Or(
+            Or(Equal(v, Splat(' ')), Equal(v, Splat('\n'))),
+            Or(Equal(v, Splat('\r')), Equal(v, Splat('\t'))));
+        if (auto mask = Mask(ws) ^ all; mask != 0)
+            return pos + std::countr_zero(mask);
     }
+#endif
+
+    while (pos != end && IsWhitespace(*pos))
+        ++pos;
+    return pos;
+}
 
-    virtual void StartObject()
+/// Returns the first character in [pos, end) for which IsStringSpecial holds,
+/// or `end`.
+inline const char* FindStringSpecial(const char* pos, const char* end)
+{
+#if defined(SAXY_JSON_AVX2) || defined(SAXY_JSON_SSE2)
+    for (; static_cast<std::size_t>(end - pos) >= vector_size; pos += vector_size)
     {
-        MaybeComma();
-        level_stack.emplace_back(false);
-        Put('{');
+        auto v = Load(pos);
+        auto special = Or(
+            Or(Equal(v, Splat('"')), Equal(v, Splat('\\'))),
+            LessEqual(v, 0x1F));
+        if (auto mask = Mask(special); mask != 0)
+            return pos + std::countr_zero(mask);
+    }
+#endif
+
+    while (pos != end && !IsStringSpecial(*pos))
+        ++pos;
+    return pos;
+}
+
+/// Characters that matter when skipping over the contents of a container:
+/// '"', '{', '}', '[' and ']'.
+constexpr bool IsSkipSpecial(char c)
+{
+    return c == '"' || c == '{' || c == '}' || c == '[' || c == ']';
+}
+
+/// Returns the first character in [pos, end) for which IsSkipSpecial holds,
+/// or `end`.
+inline const char* FindSkipSpecial(const char* pos, const char* end)
+{
+#if defined(SAXY_JSON_AVX2) || defined(SAXY_JSON_SSE2)
+    for (; static_cast<std::size_t>(end - pos) >= vector_size; pos += vector_size)
+    {
+        auto v = Load(pos);
+        // Setting bit 5 maps '[' and ']' onto '{' and '}'
+        auto folded = Or(v, Splat(0x20));
+        auto special = Or(
+            Equal(v, Splat('"')),
+            Or(Equal(folded, Splat('{')), Equal(folded, Splat('}'))));
+        if (auto mask = Mask(special); mask != 0)
+            return pos + std::countr_zero(mask);
     }
-    virtual void FinishObject()
+#endif
+
+    while (pos != end && !IsSkipSpecial(*pos))
+        ++pos;
+    return pos;
+}
+
+/// Returns the first character in [pos, end) for which IsStringSpecial holds
+/// or that is not ASCII, or `end`.
+inline const char* FindStringSpecialOrNonAscii(const char* pos, const char* end)
+{
+#if defined(SAXY_JSON_AVX2) || defined(SAXY_JSON_SSE2)
+    for (; static_cast<std::size_t>(end - pos) >= vector_size; pos += vector_size)
     {
-        level_stack.pop_back();
-        Put('}');
+        auto v = Load(pos);
+        auto special = Or(
+            Or(Equal(v, Splat('"')), Equal(v, Splat('\\'))),
+            LessEqual(v, 0x1F));
+        // The mask of `v` itself holds the high bit of every byte
+        if (auto mask = Mask(special) | Mask(v); mask != 0)
+            return pos + std::countr_zero(mask);
     }
-    virtual void StartArray()
+#endif
+
+    while (pos != end && !IsStringSpecial(*pos) && static_cast<unsigned char>(*pos) < 0x80)
+        ++pos;
+    return pos;
+}
+
+/// A byte starting a UTF-8 sequence of `length` bytes, whose second byte is
+/// in [low, high]. The range excludes overlong encodings, surrogates and code
+/// points above U+10FFFF. Bytes that cannot start a sequence have length 0.
+struct Utf8Lead
+{
+    std::uint8_t length = 0;
+    std::uint8_t low = 0x80;
+    std::uint8_t high = 0xBF;
+};
+
+inline constexpr auto utf8_leads = [] {
+    std::array<Utf8Lead, 256> leads{};
+    for (std::size_t byte = 0; byte < 0x80; ++byte)
+        leads[byte].length = 1;
+    for (std::size_t byte = 0xC2; byte <= 0xDF; ++byte)
+        leads[byte].length = 2;
+    for (std::size_t byte = 0xE0; byte <= 0xEF; ++byte)
+        leads[byte].length = 3;
+    for (std::size_t byte = 0xF0; byte <= 0xF4; ++byte)
+        leads[byte].length = 4;
+    leads[0xE0].low = 0xA0;
+    leads[0xED].high = 0x9F;
+    leads[0xF0].low = 0x90;
+    leads[0xF4].high = 0x8F;
+    return leads;
+}();
+
+/// Checks the UTF-8 sequence starting with the non-ASCII byte at `pos`.
+/// Returns the end of the sequence if it is valid, and otherwise the first
+/// byte that makes it invalid with `valid` set to false. That is `end` if the
+/// sequence is incomplete.
+inline const char* CheckUtf8Sequence(const char* pos, const char* end, bool& valid)
+{
+    auto lead = utf8_leads[static_cast<unsigned char>(*pos)];
+    valid = false;
+    if (lead.length == 0)
+        return pos;
+    for (std::size_t i = 1; i < lead.length; ++i)
     {
-        MaybeComma();
-        level_stack.push_back(false);
-        Put('[');
+        if (pos + i == end)
+            return end;
+        auto byte = static_cast<unsigned char>(pos[i]);
+        if (byte < (i == 1 ? lead.low : 0x80) || byte > (i == 1 ? lead.high : 0xBF))
+            return pos + i;
     }
-    virtual void FinishArray()
+    valid = true;
+    return pos + lead.length;
+}
+
+/// Output targets that can append a span of characters directly, such as
+/// `std::string`. Writers append to these without buffering.
+template<typename OStream>
+concept AppendSink =
+    requires(OStream& out, const char* data, std::size_t size) {
+        out.append(data, size);
+    };
+
+/// Writes a span of characters to an output target that is not an AppendSink
+template<typename OStream>
+void WriteTo(OStream& out, const char* data, std::size_t size)
+{
+    if constexpr (requires { out.write(data, std::streamsize{}); })
+        out.write(data, static_cast<std::streamsize>(size));
+    else
+        for (std::size_t i = 0; i < size; ++i)
+            out << data[i];
+}
+
+/// "00" to "99", for writing integers two digits at a time
+inline constexpr auto digit_pairs = [] {
+    std::array<char, 200> pairs{};
+    for (std::size_t i = 0; i < 100; ++i)
     {
-        level_stack.pop_back();
-        Put(']');
+        pairs[2 * i] = static_cast<char>('0' + i / 10);
+        pairs[2 * i + 1] = static_cast<char>('0' + i % 10);
     }
-    virtual void Key(std::string_view key)
+    return pairs;
+}();
+
+/// Enough characters for any `T` written by WriteInt: digits10 is one less
+/// than the largest number of digits, plus one for the sign
+template<std::integral T>
+inline constexpr std::size_t max_int_chars = std::numeric_limits<T>::digits10 + 2;
+/// Enough characters for the shortest representation of any float, double
+/// or long double
+inline constexpr std::size_t max_float_chars = 64;
+
+/// Number of decimal digits of `value`
+inline std::size_t CountDigits(std::uint64_t value)
+{
+    static constexpr std::uint64_t powers[] = {
+        0, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+        1000000000, 10000000000, 100000000000, 1000000000000, 10000000000000,
+        100000000000000, 1000000000000000, 10000000000000000,
+        100000000000000000, 1000000000000000000, 10000000000000000000u};
+    // bit_width * log10(2) underestimates the digits by at most one
+    auto guess = (static_cast<std::size_t>(std::bit_width(value)) * 1233) >> 12;
+    return guess + 1 - (value < powers[guess]);
+}
+
+/// Writes the digits of `value` to `out` and returns the end
+inline char* WriteDigits(char* out, std::uint64_t value)
+{
+    auto end = out + CountDigits(value);
+    auto pos = end;
+    while (value >= 100)
     {
-        MaybeComma();
-        Put('"');
-        WriteEscaped(key);
-        Put('"');
-        Put(':');
-        level_stack.back() = false;
+        auto pair = static_cast<std::size_t>(value % 100) * 2;
+        value /= 100;
+        *--pos = digit_pairs[pair + 1];
+        *--pos = digit_pairs[pair];
+    }
+    if (value >= 10)
+    {
+        auto pair = static_cast<std::size_t>(value) * 2;
+        *--pos = digit_pairs[pair + 1];
+        *--pos = digit_pairs[pair];
+    }
+    else
+    {
+        *--pos = static_cast<char>('0' + value);
+    }
+    return end;
+}
+
+/// Writes `value` to `out`, which must have room for max_int_chars<T>, and
+/// returns the end
+template<std::integral T>
+char* WriteInt(char* out, T value)
+{
+    if constexpr (sizeof(T) > sizeof(std::uint64_t))
+    {
+        return std::to_chars(out, out + max_int_chars<T>, value).ptr;
+    }
+    else
+    {
+        using Unsigned = std::make_unsigned_t<T>;
+        auto magnitude = static_cast<Unsigned>(value);
+        if constexpr (std::is_signed_v<T>)
+        {
+            if (value < 0)
+            {
+                *out++ = '-';
+                magnitude = static_cast<Unsigned>(0u - magnitude);
+            }
+        }
+        return WriteDigits(out, magnitude);
+    }
+}
+
+/// Writes the shortest representation of `value` that parses back to the
+/// same value to `out`, which must have room for max_float_chars, and
+/// returns the end. Integral values get a ".0", so they are read back as
+/// floats instead of integers, which may be out of range.
+template<std::floating_point T>
+char* WriteFloat(char* out, T value)
+{
+    auto end = std::to_chars(out, out + max_float_chars, value).ptr;
+    // 'n' is in "inf" and "nan"
+    if (std::none_of(out, end, [](char c) { return c == '.' || c == 'e' || c == 'n'; }))
+    {
+        *end++ = '.';
+        *end++ = '0';
+    }
+    return end;
+}
+} // namespace detail
+
+/// Common implementation of Writer and PrettyWriter.
+///
+/// The formatting of structural tokens is provided by `Derived` (`StartObject`,
+/// `FinishObject`, `StartArray`, `FinishArray` and `Key`) and dispatched
+/// statically, so no call goes through a vtable.
+///
+/// Output is collected in an internal buffer and handed to the stream in one
+/// `write` whenever `buffer_size` bytes have accumulated, on `Flush()` and on
+/// destruction. Targets satisfying detail::AppendSink (e.g. `std::string`) are
+/// appended to directly instead.
+template<typename Derived, typename OStream>
+class WriterBase
+{
+public:
+    static constexpr std::size_t default_buffer_size = 4096;
+
+    explicit WriterBase(
+        OStream& ostream, std::size_t buffer_size = default_buffer_size)
+        : ostream(ostream)
+        , buffer_size(buffer_size)
+    {
+        level_stack.push_back(false);
+        if constexpr (!detail::AppendSink<OStream>)
+            buffer.reserve(buffer_size);
     }
+    WriterBase(const WriterBase&) = delete;
+    WriterBase& operator=(const WriterBase&) = delete;
 
     void KeyValue(std::string_view key, std::integral auto value)
     {
-        Key(key);
+        Self().Key(key);
         Int(value);
     }
 
     void KeyValue(std::string_view key, std::floating_point auto value)
     {
-        Key(key);
+        Self().Key(key);
         Float(value);
     }
 
     void KeyValue(std::string_view key, bool value)
     {
-        Key(key);
+        Self().Key(key);
         Bool(value);
     }
 
     void KeyValue(std::string_view key, std::nullptr_t)
     {
-        Key(key);
+        Self().Key(key);
         Null();
     }
 
     void KeyValue(std::string_view key, std::string_view value)
     {
-        Key(key);
+        Self().Key(key);
         String(value);
     }
 
     void KeyValue(std::string_view key, const char* value)
     {
-        Key(key);
+        Self().Key(key);
         String(value);
     }
 
     void String(std::string_view str)
     {
+        MaybeComma();
         Put('"');
         WriteEscaped(str);
         Put('"');
-        level_stack.back() = true;
     }
     void Bool(bool b)
     {
+        MaybeComma();
         if (b)
             RawString("true");
         else
             RawString("false");
-        level_stack.back() = true;
     }
-    void Int(std::integral auto i)
+    template<std::integral T>
+    void Int(T i)
     {
-        std::array<char, std::numeric_limits<decltype(i)>::digits10+1> buffer{0};
-
-        if (auto [ptr, ec] =
-                std::to_chars(buffer.data(), buffer.data() + buffer.size(), i);
-            ec == std::errc())
-            RawString(buffer.data());
-        else
-            std::terminate();
-
-        level_stack.back() = true;
+        MaybeComma();
+        char digits[detail::max_int_chars<T>];
+        RawString({digits, detail::WriteInt(digits, i)});
     }
+    /// Writes the shortest representation that parses back to `f`
     void Float(std::floating_point auto f)
     {
-        std::array<char, std::numeric_limits<decltype(f)>::max_digits10+1> buffer{0};
-
-        if (auto [ptr, ec] =
-                std::to_chars(buffer.data(), buffer.data() + buffer.size(), f);
-            ec == std::errc())
-            RawString(buffer.data());
-        else
-            std::terminate();
-
-        level_stack.back() = true;
+        MaybeComma();
+        char digits[detail::max_float_chars];
+        RawString({digits, detail::WriteFloat(digits, f)});
+    }
+    /// Writes an array of integers, formatting them in batches instead of
+    /// one call per element. Accepts any contiguous range, such as
+    /// `std::span<const T>` or `std::vector<T>`.
+    template<std::ranges::contiguous_range Range>
+        requires std::integral<std::ranges::range_value_t<Range>>
+    void IntArray(const Range& values)
+    {
+        WriteArray(values, [](char* out, auto value) {
+            return detail::WriteInt(out, value);
+        }, detail::max_int_chars<std::ranges::range_value_t<Range>>);
+    }
+    /// Writes an array of floats like IntArray
+    template<std::ranges::contiguous_range Range>
+        requires std::floating_point<std::ranges::range_value_t<Range>>
+    void FloatArray(const Range& values)
+    {
+        WriteArray(values, [](char* out, auto value) {
+            return detail::WriteFloat(out, value);
+        }, detail::max_float_chars);
     }
     void Null()
     {
+        MaybeComma();
         RawString("null");
-        level_stack.back() = true;
+    }
+    /// Writes `number` unchanged, e.g. as received by a handler's RawNumber.
+    /// It must be a valid JSON number.
+    void RawNumber(std::string_view number)
+    {
+        MaybeComma();
+        RawString(number);
     }
     void RawString(std::string_view str)
     {
-        for (char c : str)
-            Put(c);
+        if constexpr (detail::AppendSink<OStream>)
+        {
+            ostream.append(str.data(), str.size());
+        }
+        else if (str.size() >= buffer_size)
+        {
+            Flush();
+            detail::WriteTo(ostream, str.data(), str.size());
+        }
+        else
+        {
+            buffer.append(str);
+            if (buffer.size() >= buffer_size)
+                Flush();
+        }
+    }
+
+    /// Hands all buffered output to the stream
+    void Flush()
+    {
+        if constexpr (!detail::AppendSink<OStream>)
+        {
+            if (!buffer.empty())
+                detail::WriteTo(ostream, buffer.data(), buffer.size());
+            buffer.clear();
+        }
     }
 
 protected:
+    ~WriterBase() { Flush(); }
+
+    Derived& Self() { return static_cast<Derived&>(*this); }
+
     void WriteEscaped(std::string_view str)
     {
-        for (char c : str)
+        auto pos = str.data();
+        auto end = pos + str.size();
+        while (true)
         {
+            // Copy everything up to the next character that needs escaping
+            auto run_end = detail::FindStringSpecial(pos, end);
+            RawString({pos, run_end});
+            if (run_end == end)
+                break;
+
+            auto c = *run_end;
             switch (c)
             {
             case '"': RawString("\\\""); break;
@@ -161,9 +560,43 @@ protected:
             case '\n': RawString("\\n"); break;
             case '\r': RawString("\\r"); break;
             case '\t': RawString("\\t"); break;
-            default: Put(c); break;
+            default:
+            {
+                constexpr std::string_view hex = "0123456789abcdef";
+                auto u = static_cast<unsigned char>(c);
+                const char escape[] = {
+                    '\\', 'u', '0', '0', hex[u >> 4], hex[u & 0xF]};
+                RawString({escape, sizeof(escape)});
+            }
+            break;
+            }
+            pos = run_end + 1;
+        }
+    }
+
+    /// Writes `values` as an array of scalars, which neither writer puts on
+    /// separate lines, collecting the formatted elements in a local chunk
+    template<typename Range, typename Format>
+    void WriteArray(const Range& values, Format format, std::size_t max_chars)
+    {
+        Self().StartArray();
+        char chunk[1024];
+        auto pos = chunk;
+        bool first = true;
+        for (auto value : values)
+        {
+            if (static_cast<std::size_t>(std::end(chunk) - pos) <= max_chars)
+            {
+                RawString({chunk, pos});
+                pos = chunk;
             }
+            if (!first)
+                *pos++ = ',';
+            first = false;
+            pos = format(pos, value);
         }
+        RawString({chunk, pos});
+        Self().FinishArray();
     }
 
     void MaybeComma()
@@ -176,36 +609,93 @@ protected:
 
     void Put(char c)
     {
-        if constexpr (requires { ostream.put(c); })
-            ostream.put(c);
+        if constexpr (requires { ostream.push_back(c); })
+        {
+            ostream.push_back(c);
+        }
+        else if constexpr (detail::AppendSink<OStream>)
+        {
+            ostream.append(&c, 1);
+        }
         else
-            ostream << c;
+        {
+            buffer.push_back(c);
+            if (buffer.size() >= buffer_size)
+                Flush();
+        }
     }
 
 
     OStream& ostream;
     std::vector<bool> level_stack;
+    std::string buffer;
+    std::size_t buffer_size;
 };
 
-template<>
-inline void Writer<std::string>::Put(char c)
+/// Writes compact JSON without any whitespace
+template<typename OStream = std::ostream>
+class Writer : public WriterBase<Writer<OStream>, OStream>
 {
-    ostream.push_back(c);
-}
+    using Base = WriterBase<Writer<OStream>, OStream>;
+
+public:
+    explicit Writer(
+        OStream& ostream, std::size_t buffer_size = Base::default_buffer_size)
+        : Base(ostream, buffer_size)
+    {}
+
+    void StartObject()
+    {
+        this->MaybeComma();
+        this->level_stack.emplace_back(false);
+        this->Put('{');
+    }
+    void FinishObject()
+    {
+        this->level_stack.pop_back();
+        this->Put('}');
+    }
+    void StartArray()
+    {
+        this->MaybeComma();
+        this->level_stack.push_back(false);
+        this->Put('[');
+    }
+    void FinishArray()
+    {
+        this->level_stack.pop_back();
+        this->Put(']');
+    }
+    void Key(std::string_view key)
+    {
+        this->MaybeComma();
+        this->Put('"');
+        this->WriteEscaped(key);
+        this->Put('"');
+        this->Put(':');
+        this->level_stack.back() = false;
+    }
+};
 
+/// Writes JSON with one member or nested container per line, indented by
+/// `indent` spaces per level
 template<typename OStream = std::ostream>
-class PrettyWriter : public Writer<OStream>
+class PrettyWriter : public WriterBase<PrettyWriter<OStream>, OStream>
 {
+    using Base = WriterBase<PrettyWriter<OStream>, OStream>;
+
 public:
-    explicit PrettyWriter(OStream& ostream, int indent = 4)
-        : Writer<OStream>(ostream)
+    explicit PrettyWriter(
+        OStream& ostream, int indent = 4,
+        std::size_t buffer_size = Base::default_buffer_size)
+        : Base(ostream, buffer_size)
         , indent_size(indent)
         , current_indent(0)
     {
         in_array_stack.push_back(false);
     }
 
-    void StartObject() override
+    void StartObject()
     {
         this->MaybeComma();
         if (in_array_stack.back())
@@ -218,7 +708,7 @@ public:
         in_array_stack.push_back(false);
         this->level_stack.push_back(false);
     }
-    void FinishObject() override
+    void FinishObject()
     {
         current_indent -= indent_size;
         this->level_stack.pop_back();
@@ -227,7 +717,7 @@ public:
         WriteIndent();
         this->Put('}');
     }
-    void StartArray() override
+    void StartArray()
     {
         this->MaybeComma();
         if (in_array_stack.back())
@@ -240,7 +730,7 @@ public:
         in_array_stack.push_back(true);
         this->level_stack.push_back(false);
     }
-    void FinishArray() override
+    void FinishArray()
     {
         current_indent -= indent_size;
         this->level_stack.pop_back();
@@ -249,7 +739,7 @@ public:
         WriteIndent();
         this->Put(']');
     }
-    void Key(std::string_view key) override
+    void Key(std::string_view key)
     {
         this->MaybeComma();
         this->Put('\n');
@@ -265,8 +755,13 @@ public:
 protected:
     void WriteIndent()
     {
-        for (int i = 0; i < current_indent; ++i)
-            this->Put(' ');
+        constexpr std::string_view spaces = "                                ";
+        for (auto n = static_cast<std::size_t>(current_indent); n > 0;)
+        {
+            auto count = std::min(n, spaces.size());
+            this->RawString(spaces.substr(0, count));
+            n -= count;
+        }
     }
 
     int indent_size;
@@ -274,383 +769,3858 @@ protected:
     std::vector<bool> in_array_stack;
 };
 
-struct Handler
+/// Optional return type of handler callbacks, for handlers that want to
+/// steer the parser. Callbacks returning void always continue.
+enum class Control
 {
-    void (*StartObject)();
-    void (*FinishObject)();
-    void (*StartArray)();
-    void (*FinishArray)();
-    void (*Key)(std::string&& key);
-    void (*String)(std::string&& val);
-    void (*Bool)(bool val);
-    void (*Int)(std::intmax_t val);
-    void (*Float)(double val);
-    void (*Null)();
-    void (*Error)(std::string&& msg);
+    Continue,
+    /// Returned from `StartObject` or `StartArray`: skips the rest of the
+    /// container, including its `FinishObject` or `FinishArray`. Returned from
+    /// `Key`: skips the value of the member. Elsewhere the same as Continue.
+    /// Skipped values are only checked for matching quotes and brackets.
+    Skip,
+    /// Stops parsing. This is not an error, so `Error` is not called.
+    Stop,
 };
 
-namespace detail
+/// Reasons parsing fails
+enum class ErrorCode : std::uint8_t
 {
-using namespace std::string_literals;
-/// json
-///     element
-template<typename THandler, typename IStream>
-void ParseJson(THandler& handler, IStream& istream);
+    None,
+    UnexpectedEof,
+    UnexpectedCharacter,
+    /// Anything but whitespace after the top-level value
+    TrailingCharacters,
+    DepthExceeded,
+    InvalidEscape,
+    InvalidUnicodeEscape,
+    /// A control character that is not escaped inside a string
+    ControlCharacter,
+    InvalidNumber,
+    NumberOutOfRange,
+    /// Reading the input failed, see `ParseResult::system_error`
+    IoError,
+    /// A value does not fit the type ParseInto parses it into
+    TypeMismatch,
+    /// A \\u escape of a UTF-16 surrogate that is not part of a high and low
+    /// surrogate pair
+    UnpairedSurrogate,
+    /// A string that is not valid UTF-8, with ParseOptions::validate_utf8
+    InvalidUtf8,
+};
 
-/// value
-///     object
-///     array
-///     string
-///     number
-///     "true"
-///     "false"
-///     "null"
-template<typename THandler, typename IStream>
-void ParseValue(THandler& handler, IStream& istream);
+/// Outcome of parsing, which converts to true on success.
+///
+/// Errors are recorded as a code and position only, so rejecting malformed
+/// input costs no allocation. The message is formatted by `Message()` on
+/// demand. Handlers with an `Error(std::string&&)` callback receive it as well.
+struct ParseResult
+{
+    ErrorCode code = ErrorCode::None;
+    /// The offending character, if there is one
+    char character = 0;
+    /// The `errno` of an ErrorCode::IoError
+    int system_error = 0;
+    /// Zero-based byte offset of the error in the input
+    std::size_t offset = 0;
+    /// One-based line and column (in bytes) of the error, or zero if unknown
+    std::size_t line = 0;
+    std::size_t column = 0;
 
-/// object
-///     '{' ws '}'
-///     '{' members '}'
-template<typename THandler, typename IStream>
-void ParseObject(THandler& handler, IStream& istream);
+    explicit operator bool() const { return code == ErrorCode::None; }
 
-/// members
-///     member
-///     member ',' members
-template<typename THandler, typename IStream>
-void ParseMembers(THandler& handler, IStream& istream);
+    std::string Message() const
+    {
+        auto quoted = [this] {
+            auto byte = static_cast<unsigned char>(character);
+            if (byte >= 0x20 && byte < 0x7f)
+                return std::string(" '") + character + "'";
+            // Show control characters and bytes of multibyte sequences as hex
+            const char* hex = "0123456789abcdef";
+            return std::string(" '\\x") + hex[byte >> 4] + hex[byte & 0xf] + "'";
+        };
+        std::string msg;
+        switch (code)
+        {
+        case ErrorCode::None: return "No error";
+        case ErrorCode::UnexpectedEof: msg = "Unexpected EOF"; break;
+        case ErrorCode::UnexpectedCharacter:
+            msg = "Unexpected character" + quoted();
+            break;
+        case ErrorCode::TrailingCharacters:
+            msg = "Unexpected character" + quoted() + " after JSON value";
+            break;
+        case ErrorCode::DepthExceeded: msg = "Maximum nesting depth exceeded"; break;
+        case ErrorCode::InvalidEscape: msg = "Invalid escape character" + quoted(); break;
+        case ErrorCode::InvalidUnicodeEscape:
+            msg = "Invalid hex character" + quoted();
+            break;
+        case ErrorCode::ControlCharacter:
+            msg = "Unescaped control character in string";
+            break;
+        case ErrorCode::InvalidNumber: msg = "Invalid number"; break;
+        case ErrorCode::NumberOutOfRange: msg = "Number out of range"; break;
+        case ErrorCode::IoError:
+            return std::string("Could not read input: ") + std::strerror(system_error);
+        case ErrorCode::TypeMismatch: msg = "Value does not match the bound type"; break;
+        case ErrorCode::UnpairedSurrogate: msg = "Unpaired UTF-16 surrogate"; break;
+        case ErrorCode::InvalidUtf8: msg = "Invalid UTF-8 at byte" + quoted(); break;
+        }
 
-/// member
-///     ws string ws ':' element
-template<typename THandler, typename IStream>
-void ParseMember(THandler& handler, IStream& istream);
+        if (line != 0)
+            return msg + " at line " + std::to_string(line) + ", column " + std::to_string(column);
+        return msg + " at offset " + std::to_string(offset);
+    }
+};
 
-/// array
-///     '[' ws ']'
-///     '[' elements ']'
-template<typename THandler, typename IStream>
-void ParseArray(THandler& handler, IStream& istream);
+/// Hash of an object key as delivered in InternedKey (32-bit FNV-1a). Usable
+/// in constant expressions, e.g. as `case KeyHash("id"):`.
+constexpr std::uint32_t KeyHash(std::string_view key)
+{
+    std::uint32_t hash = 2166136261u;
+    for (char c : key)
+        hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+    return hash;
+}
 
-/// elements
-///     element
-///     element ',' elements
-template<typename THandler, typename IStream>
-void ParseElements(THandler& handler, IStream& istream);
+/// An object key passed to handlers declaring `Key(InternedKey)`.
+///
+/// `id` is the id of the key in the KeyTable of ParseOptions, or
+/// KeyTable::none if there is no table or it is full. `view` points into the
+/// table for interned keys and is stable as long as the table; otherwise it
+/// is only valid during the callback.
+struct InternedKey
+{
+    std::uint32_t id;
+    std::uint32_t hash;
+    std::string_view view;
+};
 
-/// element
-///     ws value ws
-template<typename THandler, typename IStream>
-void ParseElement(THandler& handler, IStream& istream);
+/// Table of interned object keys, bounded in the number of keys and their
+/// total size, and reused across parses.
+///
+/// Keys get ids in the order they are first seen, starting at zero. Handlers
+/// can intern the keys they care about before parsing and then switch on the
+/// ids of the keys they receive, instead of comparing strings. Once the table
+/// is full, new keys are passed with KeyTable::none as id. A table must not be
+/// used by several parses at the same time.
+class KeyTable
+{
+public:
+    static constexpr std::uint32_t none = std::numeric_limits<std::uint32_t>::max();
+
+    explicit KeyTable(std::size_t max_keys = 4096, std::size_t max_bytes = 1 << 16)
+        : slots(std::bit_ceil(std::max<std::size_t>(max_keys * 2, 1)))
+        , storage(std::make_unique<char[]>(max_bytes))
+        , max_keys(std::min<std::size_t>(max_keys, none))
+        , max_bytes(max_bytes)
+    {
+        keys.reserve(this->max_keys);
+    }
+
+    /// Returns the id of `key`, adding it unless the table is full
+    std::uint32_t Intern(std::string_view key) { return Intern(key, KeyHash(key)).id; }
+
+    /// Interns `key` with its precomputed KeyHash
+    InternedKey Intern(std::string_view key, std::uint32_t hash)
+    {
+        // Linear probing in a table at most half full
+        auto mask = slots.size() - 1;
+        for (auto i = hash & mask;; i = (i + 1) & mask)
+        {
+            auto& slot = slots[i];
+            if (slot.id == none)
+            {
+                if (keys.size() == max_keys || key.size() > max_bytes - used)
+                    return {none, hash, key};
+
+                auto copy = storage.get() + used;
+                std::memcpy(copy, key.data(), key.size());
+                used += key.size();
+                slot = {hash, static_cast<std::uint32_t>(keys.size())};
+                keys.emplace_back(copy, key.size());
+                return {slot.id, hash, keys.back()};
+            }
+            if (slot.hash == hash && keys[slot.id] == key)
+                return {slot.id, hash, keys[slot.id]};
+        }
+    }
+
+    /// The id of `key`, or `none` if it has not been interned
+    std::uint32_t Find(std::string_view key) const
+    {
+        auto hash = KeyHash(key);
+        auto mask = slots.size() - 1;
+        for (auto i = hash & mask; slots[i].id != none; i = (i + 1) & mask)
+        {
+            if (slots[i].hash == hash && keys[slots[i].id] == key)
+                return slots[i].id;
+        }
+        return none;
+    }
+
+    std::string_view Key(std::uint32_t id) const { return keys[id]; }
+    std::size_t Size() const { return keys.size(); }
+
+    /// Removes all keys, keeping the memory
+    void Clear()
+    {
+        std::fill(slots.begin(), slots.end(), Slot());
+        keys.clear();
+        used = 0;
+    }
+
+private:
+    struct Slot
+    {
+        std::uint32_t hash = 0;
+        std::uint32_t id = none;
+    };
+
+    std::vector<Slot> slots;
+    std::vector<std::string_view> keys;
+    // Never reallocated, so the views of interned keys stay valid
+    std::unique_ptr<char[]> storage;
+    std::size_t used = 0;
+    std::size_t max_keys;
+    std::size_t max_bytes;
+};
+
+/// Options controlling Parse
+struct ParseOptions
+{
+    /// Maximum nesting depth of objects and arrays. Deeper documents are
+    /// rejected with an error instead of exhausting memory.
+    std::size_t max_depth = 512;
+    /// Table interning the keys passed to handlers declaring
+    /// `Key(InternedKey)`. Without a table, these handlers get the hash and
+    /// view of keys only.
+    KeyTable* keys = nullptr;
+    /// Reject keys and strings that are not valid UTF-8 (overlong encodings,
+    /// surrogates and truncated sequences included) with
+    /// ErrorCode::InvalidUtf8. Checked while scanning strings, with a
+    /// vectorised fast path for ASCII. Values skipped by the handler or a
+    /// Projection are not checked.
+    bool validate_utf8 = false;
+};
+
+/// A selection of the values in a document, given as JSON pointers (RFC 6901)
+/// like "/user/id". The token "*" matches every member of an object and every
+/// element of an array, as in "/events/*/ts".
+///
+/// With ParseProjected, the handler only receives the selected
+/// values and the keys and containers leading to them. Everything else is
+/// skipped by matching quotes and brackets, without unescaping strings,
+/// converting numbers or calling the handler, and is therefore not fully
+/// validated.
+class Projection
+{
+public:
+    static constexpr std::uint32_t none = std::numeric_limits<std::uint32_t>::max();
+    static constexpr std::uint32_t root = 0;
+
+    Projection()
+        : nodes(1)
+    {}
+    Projection(std::initializer_list<std::string_view> pointers)
+        : Projection()
+    {
+        for (auto pointer : pointers)
+            Add(pointer);
+    }
+
+    /// Selects the value at `pointer` with everything nested in it. The empty
+    /// pointer selects the whole document.
+    ///
+    /// Throws std::invalid_argument if `pointer` is not a JSON pointer.
+    void Add(std::string_view pointer)
+    {
+        if (!pointer.empty() && pointer[0] != '/')
+        {
+            throw std::invalid_argument(
+                "JSON pointer must start with '/': " + std::string(pointer));
+        }
+
+        std::vector<std::string> tokens;
+        for (std::size_t pos = 0; pos < pointer.size();)
+        {
+            auto next = std::min(pointer.find('/', pos + 1), pointer.size());
+            auto& token = tokens.emplace_back();
+            for (auto i = pos + 1; i < next; ++i)
+            {
+                if (pointer[i] != '~')
+                    token += pointer[i];
+                else if (i + 1 < next && (pointer[i + 1] == '0' || pointer[i + 1] == '1'))
+                    token += pointer[++i] == '0' ? '~' : '/';
+                else
+                    throw std::invalid_argument(
+                        "Invalid escape in JSON pointer: " + std::string(pointer));
+            }
+            pos = next;
+        }
+        Insert(root, tokens, 0);
+    }
+
+    /// Whether the value at `node` is selected as a whole
+    bool Selected(std::uint32_t node) const { return nodes[node].selected; }
+
+    /// The node for the member `key` of the object at `node`, or `none`
+    std::uint32_t Child(std::uint32_t node, std::string_view key) const
+    {
+        for (const auto& child : nodes[node].children)
+            if (child.key == key)
+                return child.node;
+        return nodes[node].wildcard;
+    }
+
+    /// The node for the element `index` of the array at `node`, or `none`
+    std::uint32_t Child(std::uint32_t node, std::size_t index) const
+    {
+        for (const auto& child : nodes[node].children)
+            if (child.index == index)
+                return child.node;
+        return nodes[node].wildcard;
+    }
+
+private:
+    static constexpr std::size_t no_index = std::numeric_limits<std::size_t>::max();
+
+    struct Edge
+    {
+        std::string key;
+        /// `key` as an array index, or `no_index`
+        std::size_t index;
+        std::uint32_t node;
+    };
+
+    /// Every named child also contains everything selected through the
+    /// wildcard, so a lookup only ever has to follow a single edge.
+    struct Node
+    {
+        std::vector<Edge> children;
+        std::uint32_t wildcard = none;
+        bool selected = false;
+    };
+
+    void Insert(std::uint32_t node, const std::vector<std::string>& tokens, std::size_t i)
+    {
+        if (nodes[node].selected)
+            return;
+        if (i == tokens.size())
+        {
+            nodes[node].selected = true;
+            return;
+        }
+
+        const auto& token = tokens[i];
+        if (token == "*")
+        {
+            if (nodes[node].wildcard == none)
+            {
+                auto wildcard = NewNode();
+                nodes[node].wildcard = wildcard;
+            }
+            Insert(nodes[node].wildcard, tokens, i + 1);
+            for (std::size_t c = 0; c < nodes[node].children.size(); ++c)
+                Insert(nodes[node].children[c].node, tokens, i + 1);
+            return;
+        }
+
+        auto child = none;
+        for (const auto& edge : nodes[node].children)
+            if (edge.key == token)
+                child = edge.node;
+        if (child == none)
+        {
+            child = nodes[node].wildcard != none ? Clone(nodes[node].wildcard) : NewNode();
+            nodes[node].children.push_back({token, ToIndex(token), child});
+        }
+        Insert(child, tokens, i + 1);
+    }
+
+    std::uint32_t NewNode()
+    {
+        nodes.emplace_back();
+        return static_cast<std::uint32_t>(nodes.size() - 1);
+    }
+
+    std::uint32_t Clone(std::uint32_t node)
+    {
+        auto copy = NewNode();
+        nodes[copy].selected = nodes[node].selected;
+        if (nodes[node].wildcard != none)
+        {
+            auto wildcard = Clone(nodes[node].wildcard);
+            nodes[copy].wildcard = wildcard;
+        }
+        for (std::size_t c = 0; c < nodes[node].children.size(); ++c)
+        {
+            auto edge = nodes[node].children[c];
+            edge.node = Clone(edge.node);
+            nodes[copy].children.push_back(std::move(edge));
+        }
+        return copy;
+    }
+
+    /// Array indices are decimal numbers without leading zeros
+    static std::size_t ToIndex(std::string_view token)
+    {
+        std::size_t index = 0;
+        auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), index);
+        if (token.empty() || ec != std::errc{} || ptr != token.data() + token.size()
+            || (token.size() > 1 && token[0] == '0'))
+            return no_index;
+        return index;
+    }
+
+    std::vector<Node> nodes;
+};
+
+struct Handler
+{
+    void (*StartObject)();
+    void (*FinishObject)();
+    void (*StartArray)();
+    void (*FinishArray)();
+    void (*Key)(std::string&& key);
+    void (*String)(std::string&& val);
+    void (*Bool)(bool val);
+    void (*Int)(std::intmax_t val);
+    void (*Float)(double val);
+    void (*Null)();
+    void (*Error)(std::string&& msg);
+};
+
+/// Non-owning, type-erased reference to a handler.
+///
+/// The parser is instantiated once for HandlerRef and then serves any handler,
+/// e.g. in a precompiled plugin or across a shared library boundary. A
+/// HandlerRef is a context pointer and a pointer to a static table of
+/// callbacks, so creating one never allocates and every event costs a single
+/// indirect call. Unlike `Handler`, every HandlerRef has its own context, so
+/// several can parse concurrently.
+///
+/// The referenced handler may declare its callbacks like any other handler,
+/// returning void or Control and taking strings as `std::string_view` or
+/// `std::string&&`. Optional callbacks like `Uint`, `RawNumber` and
+/// `Key(InternedKey)` are forwarded if the handler declares them, and the parser behaves as if it
+/// was given the handler itself. It must outlive the HandlerRef, and copies
+/// of a HandlerRef refer to the same handler.
+class HandlerRef
+{
+public:
+    /// Callbacks, each called with the context pointer. `Error` and the
+    /// optional callbacks after it may be null. `Int` and `Float` are only
+    /// called if `RawNumber` is null, and `Key` only if `InternedKey` is.
+    struct VTable
+    {
+        Control (*StartObject)(void* context);
+        Control (*FinishObject)(void* context);
+        Control (*StartArray)(void* context);
+        Control (*FinishArray)(void* context);
+        Control (*Key)(void* context, std::string_view key);
+        Control (*String)(void* context, std::string_view val);
+        Control (*Bool)(void* context, bool val);
+        Control (*Int)(void* context, std::intmax_t val);
+        Control (*Float)(void* context, double val);
+        Control (*Null)(void* context);
+        void (*Error)(void* context, std::string&& msg);
+        Control (*Uint)(void* context, std::uint64_t val) = nullptr;
+        Control (*RawNumber)(void* context, std::string_view number) = nullptr;
+        Control (*Interned)(void* context, InternedKey key) = nullptr;
+    };
+
+    template<typename THandler>
+        requires(!std::same_as<THandler, HandlerRef>)
+    HandlerRef(THandler& handler)
+        : context(&handler)
+        , vtable(&vtable_for<THandler>)
+    {}
+
+    /// Refers to a handler implemented by hand, e.g. behind a C interface
+    HandlerRef(void* context, const VTable& vtable)
+        : context(context)
+        , vtable(&vtable)
+    {}
+
+    Control StartObject() { return vtable->StartObject(context); }
+    Control FinishObject() { return vtable->FinishObject(context); }
+    Control StartArray() { return vtable->StartArray(context); }
+    Control FinishArray() { return vtable->FinishArray(context); }
+    Control Key(std::string_view key) { return vtable->Key(context, key); }
+    Control String(std::string_view val) { return vtable->String(context, val); }
+    Control Bool(bool val) { return vtable->Bool(context, val); }
+    Control Int(std::intmax_t val) { return vtable->Int(context, val); }
+    Control Float(double val) { return vtable->Float(context, val); }
+    Control Null() { return vtable->Null(context); }
+    void Error(std::string&& msg)
+    {
+        if (vtable->Error != nullptr)
+            vtable->Error(context, std::move(msg));
+    }
+    Control Uint(std::uint64_t val) { return vtable->Uint(context, val); }
+    Control RawNumber(std::string_view number) { return vtable->RawNumber(context, number); }
+    Control Key(InternedKey key) { return vtable->Interned(context, key); }
+
+    /// The parser checks which optional callbacks are set before calling them
+    const VTable& Callbacks() const { return *vtable; }
+
+private:
+    /// Calls a callback of the referenced handler, which may return void
+    template<typename Callback>
+    static Control Forward(Callback&& callback)
+    {
+        if constexpr (std::same_as<std::invoke_result_t<Callback>, Control>)
+        {
+            return callback();
+        }
+        else
+        {
+            callback();
+            return Control::Continue;
+        }
+    }
+
+    /// Passes `str` as a view if the handler takes one, otherwise as a copy
+    template<typename THandler>
+    static Control ForwardKey(THandler& handler, std::string_view str)
+    {
+        if constexpr (requires { handler.Key(str); })
+            return Forward([&] { return handler.Key(str); });
+        else
+            return Forward([&] { return handler.Key(std::string(str)); });
+    }
+    template<typename THandler>
+    static Control ForwardString(THandler& handler, std::string_view str)
+    {
+        if constexpr (requires { handler.String(str); })
+            return Forward([&] { return handler.String(str); });
+        else
+            return Forward([&] { return handler.String(std::string(str)); });
+    }
+
+    template<typename THandler>
+    static THandler& Get(void* context)
+    {
+        return *static_cast<THandler*>(context);
+    }
+
+    template<typename THandler>
+    static constexpr VTable vtable_for = {
+        [](void* context) {
+            return Forward([&] { return Get<THandler>(context).StartObject(); });
+        },
+        [](void* context) {
+            return Forward([&] { return Get<THandler>(context).FinishObject(); });
+        },
+        [](void* context) {
+            return Forward([&] { return Get<THandler>(context).StartArray(); });
+        },
+        [](void* context) {
+            return Forward([&] { return Get<THandler>(context).FinishArray(); });
+        },
+        []() -> Control (*)(void*, std::string_view) {
+            if constexpr (requires(THandler& h) { h.Key(std::string()); })
+            {
+                return [](void* context, std::string_view key) {
+                    return ForwardKey(Get<THandler>(context), key);
+                };
+            }
+            else
+            {
+                return nullptr;
+            }
+        }(),
+        [](void* context, std::string_view val) {
+            return ForwardString(Get<THandler>(context), val);
+        },
+        [](void* context, bool val) {
+            return Forward([&] { return Get<THandler>(context).Bool(val); });
+        },
+        []() -> Control (*)(void*, std::intmax_t) {
+            if constexpr (requires(THandler& h) { h.Int(std::intmax_t{}); })
+            {
+                return [](void* context, std::intmax_t val) {
+                    return Forward([&] { return Get<THandler>(context).Int(val); });
+                };
+            }
+            else
+            {
+                return nullptr;
+            }
+        }(),
+        []() -> Control (*)(void*, double) {
+            if constexpr (requires(THandler& h) { h.Float(double{}); })
+            {
+                return [](void* context, double val) {
+                    return Forward([&] { return Get<THandler>(context).Float(val); });
+                };
+            }
+            else
+            {
+                return nullptr;
+            }
+        }(),
+        [](void* context) {
+            return Forward([&] { return Get<THandler>(context).Null(); });
+        },
+        []() -> void (*)(void*, std::string&&) {
+            if constexpr (requires(THandler& h) { h.Error(std::string()); })
+            {
+                return [](void* context, std::string&& msg) {
+                    Get<THandler>(context).Error(std::move(msg));
+                };
+            }
+            else
+            {
+                return nullptr;
+            }
+        }(),
+        []() -> Control (*)(void*, std::uint64_t) {
+            if constexpr (requires(THandler& h) { h.Uint(std::uint64_t{}); })
+            {
+                return [](void* context, std::uint64_t val) {
+                    return Forward([&] { return Get<THandler>(context).Uint(val); });
+                };
+            }
+            else
+            {
+                return nullptr;
+            }
+        }(),
+        []() -> Control (*)(void*, std::string_view) {
+            if constexpr (requires(THandler& h) { h.RawNumber(std::string_view()); })
+            {
+                return [](void* context, std::string_view number) {
+                    return Forward([&] { return Get<THandler>(context).RawNumber(number); });
+                };
+            }
+            else
+            {
+                return nullptr;
+            }
+        }(),
+        []() -> Control (*)(void*, InternedKey) {
+            if constexpr (requires(THandler& h, InternedKey key) { h.Key(key); })
+            {
+                return [](void* context, InternedKey key) {
+                    return Forward([&] { return Get<THandler>(context).Key(key); });
+                };
+            }
+            else
+            {
+                return nullptr;
+            }
+        }(),
+    };
+
+    void* context;
+    const VTable* vtable;
+};
+
+namespace detail
+{
+using namespace std::string_literals;
+/// json
+///     element
+template<typename THandler, typename IStream>
+bool ParseJson(
+    THandler& handler, IStream& istream, const ParseOptions& options);
+
+/// element
+///     ws value ws
+///
+/// object
+///     '{' ws '}'
+///     '{' members '}'
+///
+/// members
+///     member
+///     member ',' members
+///
+/// member
+///     ws string ws ':' element
+///
+/// array
+///     '[' ws ']'
+///     '[' elements ']'
+///
+/// elements
+///     element
+///     element ',' elements
+///
+/// Objects and arrays are parsed iteratively with an explicit stack of open
+/// containers, so the nesting depth is only bounded by
+/// `ParseOptions::max_depth` and not by the call stack.
+template<typename THandler, typename IStream>
+bool ParseElement(
+    THandler& handler, IStream& istream, const ParseOptions& options);
+
+/// value
+///     string
+///     number
+///     "true"
+///     "false"
+///     "null"
+///
+/// Objects and arrays are handled by ParseJson.
+template<typename THandler, typename IStream>
+bool ParseValue(THandler& handler, IStream& istream);
+
+/// member
+///     ws string ws ':'
+///
+/// The value of the member is parsed by ParseJson. Returns what the handler
+/// returned from `Key`, or Control::Stop on errors.
+template<typename THandler, typename IStream>
+Control ParseKey(THandler& handler, IStream& istream, const ParseOptions& options);
+
+/// The string of a member, passed to `handler.Key`
+template<typename THandler, typename IStream>
+Control ParseKeyString(
+    THandler& handler, IStream& istream, const ParseOptions& options);
+
+/// Passes a key that has been read to `handler.Key`
+template<typename THandler, typename IStream>
+Control EmitKey(
+    THandler& handler, IStream& istream, std::string_view key,
+    const ParseOptions& options);
 
 /// string
 ///     '"' characters '"'
 template<typename THandler, typename IStream>
-void ParseString(THandler& handler, IStream& istream);
+bool ParseString(THandler& handler, IStream& istream);
+
+/// number
+///     integer fraction exponent
+template<typename THandler, typename IStream>
+bool ParseNumber(THandler& handler, IStream& istream);
+
+/// bool-literal
+///     "true"
+///     "false"
+template<typename THandler, typename IStream>
+bool ParseBoolLiteral(THandler& handler, IStream& istream);
+
+/// null
+template<typename THandler, typename IStream>
+bool ParseNull(THandler& handler, IStream& istream);
+
+/// Skips a value without calling the handler, or with `depth` 1 the rest of a
+/// container whose opening bracket has been read. Only quotes and brackets are
+/// matched: strings are not unescaped, numbers not converted and the contents
+/// of containers not validated.
+template<typename THandler, typename IStream>
+bool SkipValue(THandler& handler, IStream& istream, std::size_t depth = 0);
+
+/// Input cursor over a contiguous in-memory buffer.
+///
+/// Provides the `peek()`/`get()` subset of the `std::istream` interface the
+/// parser relies on, so the detail::Parse* family can run on either. Functions
+/// that have a faster pointer-based implementation check for this type with
+/// `if constexpr (IsBufferReader<IStream>)`.
+class BufferReader
+{
+public:
+    BufferReader(const char* begin, const char* end)
+        : begin(begin)
+        , pos(begin)
+        , end(end)
+    {}
+
+    int peek() const
+    {
+        return pos != end ? static_cast<unsigned char>(*pos) : EOF;
+    }
+    int get()
+    {
+        return pos != end ? static_cast<unsigned char>(*pos++) : EOF;
+    }
+
+    /// Records an error at the current position, or at the previous character
+    /// if `consumed`. Lines are only counted once the result is requested.
+    void Fail(ErrorCode code, int ch, bool consumed)
+    {
+        error = code;
+        error_character = ch == EOF ? '\0' : static_cast<char>(ch);
+        error_pos = consumed ? pos - 1 : pos;
+    }
+
+    /// The recorded error, located relative to `begin`
+    ParseResult Result() const
+    {
+        ParseResult result;
+        result.code = error;
+        if (error == ErrorCode::None)
+            return result;
+
+        result.character = error_character;
+        result.offset = static_cast<std::size_t>(error_pos - begin);
+        auto line_start = begin;
+        result.line = 1;
+        for (auto newline = begin;
+             newline != error_pos
+             && (newline = static_cast<const char*>(std::memchr(
+                     newline, '\n', static_cast<std::size_t>(error_pos - newline))));
+             ++newline)
+        {
+            ++result.line;
+            line_start = newline + 1;
+        }
+        result.column = static_cast<std::size_t>(error_pos - line_start) + 1;
+        return result;
+    }
+
+    const char* begin;
+    const char* pos;
+    const char* end;
+    /// Reused storage for strings that need unescaping
+    std::string scratch;
+    /// Set when the handler returned Control::Stop, to tell it apart from an
+    /// error where parsing also ends
+    bool stopped = false;
+    /// Copied from ParseOptions when parsing starts
+    bool validate_utf8 = false;
+
+    ErrorCode error = ErrorCode::None;
+    char error_character = 0;
+    const char* error_pos = nullptr;
+};
+
+template<typename IStream>
+constexpr bool IsBufferReader = std::same_as<IStream, BufferReader>;
+
+/// Input cursor over a stream providing `peek()` and `get()`, such as
+/// `std::istream`. Counts lines while reading, to locate errors.
+template<typename IStream>
+class StreamReader
+{
+public:
+    explicit StreamReader(IStream& istream)
+        : istream(istream)
+    {}
+
+    int peek() { return istream.peek(); }
+    int get()
+    {
+        int ch = istream.get();
+        if (ch != EOF)
+        {
+            ++offset;
+            if (ch == '\n')
+            {
+                previous_line_start = line_start;
+                line_start = offset;
+                ++line;
+            }
+        }
+        return ch;
+    }
+
+    /// Records an error at the current position, or at the previous character
+    /// if `consumed`
+    void Fail(ErrorCode code, int ch, bool consumed)
+    {
+        result.code = code;
+        result.character = ch == EOF ? '\0' : static_cast<char>(ch);
+        result.offset = offset;
+        result.line = line;
+        result.column = offset - line_start + 1;
+        if (consumed && offset != 0)
+        {
+            --result.offset;
+            if (ch == '\n')
+            {
+                --result.line;
+                result.column = result.offset - previous_line_start + 1;
+            }
+            else
+            {
+                --result.column;
+            }
+        }
+    }
+
+    const ParseResult& Result() const { return result; }
+
+    /// Set when the handler returned Control::Stop
+    bool stopped = false;
+    /// Copied from ParseOptions when parsing starts
+    bool validate_utf8 = false;
+    /// Reused storage for keys
+    std::string scratch;
+
+private:
+    IStream& istream;
+    ParseResult result;
+    std::size_t offset = 0;
+    std::size_t line = 1;
+    std::size_t line_start = 0;
+    std::size_t previous_line_start = 0;
+};
+
+/// Handlers opting into zero-copy strings accept `Key` and `String` as
+/// `std::string_view`. When parsing from a buffer the views point into the
+/// input, or into a scratch buffer for strings containing escapes, and are only
+/// valid for the duration of the callback.
+template<typename THandler>
+concept StringViewHandler = requires(THandler& handler, std::string_view str) {
+    handler.Key(str);
+    handler.String(str);
+};
+
+/// Handlers receiving keys as InternedKey
+template<typename THandler>
+concept InternedKeyHandler = requires(THandler& handler, InternedKey key) {
+    handler.Key(key);
+};
+
+/// Handlers declaring `RawNumber(std::string_view)` receive every number as
+/// its unconverted characters instead of `Int` or `Float`. Numbers are still
+/// validated, but never converted, so none is out of range.
+template<typename THandler>
+concept RawNumberHandler = requires(THandler& handler, std::string_view number) {
+    handler.RawNumber(number);
+};
+
+/// Handlers declaring `Uint(std::uint64_t)` receive positive integers that do
+/// not fit `std::intmax_t` there, instead of failing with
+/// ErrorCode::NumberOutOfRange
+template<typename THandler>
+concept UintHandler = requires(THandler& handler, std::uint64_t value) {
+    handler.Uint(value);
+};
+
+/// HandlerRef declares every optional callback, but only knows at run time
+/// whether the referenced handler takes them
+template<typename THandler>
+concept ErasedHandler = std::same_as<THandler, HandlerRef>;
+
+template<typename THandler>
+bool TakesRawNumbers([[maybe_unused]] const THandler& handler)
+{
+    if constexpr (ErasedHandler<THandler>)
+        return handler.Callbacks().RawNumber != nullptr;
+    else
+        return RawNumberHandler<THandler>;
+}
+
+template<typename THandler>
+bool TakesUints([[maybe_unused]] const THandler& handler)
+{
+    if constexpr (ErasedHandler<THandler>)
+        return handler.Callbacks().Uint != nullptr;
+    else
+        return UintHandler<THandler>;
+}
+
+/// Records an error in the reader. Always returns false, so parse functions
+/// can `return Fail(...)` to stop parsing. `ch` is the offending character,
+/// which is the next one to be read unless it has been `consumed` already.
+template<typename IStream>
+bool Fail(IStream& istream, ErrorCode code, int ch = EOF, bool consumed = false)
+{
+    istream.Fail(code, ch, consumed);
+    return false;
+}
+
+/// Fails on the unexpected character `ch`, or EOF
+template<typename IStream>
+bool Unexpected(IStream& istream, int ch, bool consumed = false)
+{
+    if (ch == EOF)
+        return Fail(istream, ErrorCode::UnexpectedEof);
+    return Fail(istream, ErrorCode::UnexpectedCharacter, ch, consumed);
+}
+
+/// Passes the error of a finished parse to `handler.Error`, if the handler
+/// has one, and returns it
+template<typename THandler>
+ParseResult Report(THandler& handler, const ParseResult& result)
+{
+    if constexpr (requires { handler.Error(std::string()); })
+    {
+        if (!result)
+            handler.Error(result.Message());
+    }
+    return result;
+}
+
+/// Calls a handler callback and returns how the handler wants to go on. For
+/// callbacks returning void this is always Control::Continue, known at compile
+/// time, so handlers not using Control pay nothing for it. A Stop is also
+/// recorded in the reader.
+template<typename IStream, typename Callback>
+Control Emit(IStream& istream, Callback&& callback)
+{
+    if constexpr (std::same_as<std::invoke_result_t<Callback>, Control>)
+    {
+        auto control = callback();
+        if (control == Control::Stop)
+            istream.stopped = true;
+        return control;
+    }
+    else
+    {
+        callback();
+        return Control::Continue;
+    }
+}
+
+/// Stack of the currently open containers, one bit per level that is set for
+/// objects. The first levels are stored inline so shallow documents do not
+/// allocate.
+class ContainerStack
+{
+public:
+    void push(bool is_object)
+    {
+        auto word = count / 64;
+        auto bit = std::uint64_t{1} << (count % 64);
+        if (word == small.size() + large.size())
+            large.push_back(0);
+
+        auto& bits = Word(word);
+        bits = is_object ? (bits | bit) : (bits & ~bit);
+        ++count;
+    }
+    void pop() { --count; }
+    bool top() const
+    {
+        auto index = count - 1;
+        return (Word(index / 64) >> (index % 64)) & 1;
+    }
+    bool empty() const { return count == 0; }
+    std::size_t size() const { return count; }
+
+private:
+    std::uint64_t& Word(std::size_t word)
+    {
+        return word < small.size() ? small[word] : large[word - small.size()];
+    }
+    const std::uint64_t& Word(std::size_t word) const
+    {
+        return word < small.size() ? small[word] : large[word - small.size()];
+    }
+
+    std::array<std::uint64_t, 4> small{};
+    std::vector<std::uint64_t> large;
+    std::size_t count = 0;
+};
+
+template<typename IStream>
+bool AddToString(std::string& str, int ch, IStream& istream)
+{
+    if (ch == EOF)
+        return Fail(istream, ErrorCode::UnexpectedEof);
+
+    str += static_cast<char>(ch);
+    return true;
+}
+
+template<typename THandler, typename IStream>
+void SkipWhitespace([[maybe_unused]] THandler& handler, IStream& istream)
+{
+    if constexpr (IsBufferReader<IStream>)
+    {
+        istream.pos = FindNonWhitespace(istream.pos, istream.end);
+        return;
+    }
+
+    auto ch = istream.peek();
+    while (ch == ' ' || ch == '\n' || ch == '\r' || ch == '\t')
+    {
+        istream.get();
+        ch = istream.peek();
+    }
+}
+
+template<typename THandler, typename IStream>
+bool Expect(int c, [[maybe_unused]] THandler& handler, IStream& istream)
+{
+    int ch = istream.get();
+    if (ch != c)
+        return Unexpected(istream, ch, true);
+    return true;
+}
+
+/// Value of each hexadecimal digit, and -1 for all other characters
+inline constexpr auto hex_digits = [] {
+    std::array<std::int8_t, 256> digits{};
+    digits.fill(-1);
+    for (int i = 0; i < 10; ++i)
+        digits['0' + i] = static_cast<std::int8_t>(i);
+    for (int i = 0; i < 6; ++i)
+    {
+        digits['a' + i] = static_cast<std::int8_t>(10 + i);
+        digits['A' + i] = static_cast<std::int8_t>(10 + i);
+    }
+    return digits;
+}();
+
+/// Reads the four hexadecimal digits of a \\u escape into `value`
+template<typename IStream>
+bool GetHex4(IStream& istream, std::uint32_t& value)
+{
+    if constexpr (IsBufferReader<IStream>)
+    {
+        // Decode all four digits at once. Invalid input is handled below,
+        // which reports the offending character.
+        if (istream.end - istream.pos >= 4)
+        {
+            auto digit = [&](int i) -> std::int32_t {
+                return hex_digits[static_cast<unsigned char>(istream.pos[i])];
+            };
+            auto a = digit(0), b = digit(1), c = digit(2), d = digit(3);
+            if ((a | b | c | d) >= 0)
+            {
+                value = static_cast<std::uint32_t>(a << 12 | b << 8 | c << 4 | d);
+                istream.pos += 4;
+                return true;
+            }
+        }
+    }
+
+    value = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        auto ch = istream.peek();
+        if (ch == EOF)
+            return Fail(istream, ErrorCode::UnexpectedEof);
+        auto digit = hex_digits[static_cast<unsigned char>(ch)];
+        if (digit < 0)
+            return Fail(istream, ErrorCode::InvalidUnicodeEscape, ch);
+        istream.get();
+        value = value << 4 | static_cast<std::uint32_t>(digit);
+    }
+    return true;
+}
+
+/// Appends the UTF-8 encoding of `code_point`, which is not a surrogate
+inline void AppendUtf8(std::string& str, std::uint32_t code_point)
+{
+    auto byte = [](std::uint32_t bits) { return static_cast<char>(bits); };
+    if (code_point < 0x80)
+    {
+        str += byte(code_point);
+    }
+    else if (code_point < 0x800)
+    {
+        str += byte(0xC0 | code_point >> 6);
+        str += byte(0x80 | (code_point & 0x3F));
+    }
+    else if (code_point < 0x10000)
+    {
+        str += byte(0xE0 | code_point >> 12);
+        str += byte(0x80 | (code_point >> 6 & 0x3F));
+        str += byte(0x80 | (code_point & 0x3F));
+    }
+    else
+    {
+        str += byte(0xF0 | code_point >> 18);
+        str += byte(0x80 | (code_point >> 12 & 0x3F));
+        str += byte(0x80 | (code_point >> 6 & 0x3F));
+        str += byte(0x80 | (code_point & 0x3F));
+    }
+}
+
+/// Decodes the escape sequence following a '\\' and appends it to `str`.
+/// \\u escapes are converted to UTF-8, combining surrogate pairs and
+/// rejecting unpaired surrogates.
+template<typename THandler, typename IStream>
+bool GetEscape(std::string& str, [[maybe_unused]] THandler& handler, IStream& istream)
+{
+    auto ch = istream.get();
+    switch (ch)
+    {
+    case '"': str += '"'; break;
+    case '\\': str += '\\'; break;
+    case '/': str += '/'; break;
+    case 'b': str += '\b'; break;
+    case 'f': str += '\f'; break;
+    case 'n': str += '\n'; break;
+    case 'r': str += '\r'; break;
+    case 't': str += '\t'; break;
+    case 'u':
+    {
+        std::uint32_t code_point;
+        if (!GetHex4(istream, code_point))
+            return false;
+        if (code_point >= 0xD800 && code_point <= 0xDFFF)
+        {
+            // A high surrogate must be followed by an escaped low surrogate
+            if (code_point >= 0xDC00)
+                return Fail(istream, ErrorCode::UnpairedSurrogate);
+            for (char expected : {'\\', 'u'})
+            {
+                auto next = istream.peek();
+                if (next == EOF)
+                    return Fail(istream, ErrorCode::UnexpectedEof);
+                if (next != expected)
+                    return Fail(istream, ErrorCode::UnpairedSurrogate);
+                istream.get();
+            }
+            std::uint32_t low;
+            if (!GetHex4(istream, low))
+                return false;
+            if (low < 0xDC00 || low > 0xDFFF)
+                return Fail(istream, ErrorCode::UnpairedSurrogate);
+            code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+        }
+        AppendUtf8(str, code_point);
+    }
+    break;
+    default:
+        if (ch == EOF)
+            return Fail(istream, ErrorCode::UnexpectedEof);
+        return Fail(istream, ErrorCode::InvalidEscape, ch, true);
+    }
+    return true;
+}
+
+/// Returns the first character of string content from `pos` for which
+/// IsStringSpecial holds, or the end of the buffer, like FindStringSpecial.
+/// With `reader.validate_utf8`, multibyte sequences are checked in the same
+/// pass, and invalid ones fail and return nullptr. An incomplete sequence at
+/// the end of the buffer is left to be reported as an unterminated string.
+inline const char* ScanString(BufferReader& reader, const char* pos)
+{
+    if (!reader.validate_utf8)
+        return FindStringSpecial(pos, reader.end);
+
+    while (true)
+    {
+        pos = FindStringSpecialOrNonAscii(pos, reader.end);
+        if (pos == reader.end || static_cast<unsigned char>(*pos) < 0x80)
+            return pos;
+        // Non-ASCII text tends to come in runs of multibyte sequences
+        do
+        {
+            bool valid;
+            pos = CheckUtf8Sequence(pos, reader.end, valid);
+            if (!valid)
+            {
+                if (pos == reader.end)
+                    return pos;
+                reader.pos = pos;
+                Fail(reader, ErrorCode::InvalidUtf8, reader.peek());
+                return nullptr;
+            }
+        } while (pos != reader.end && static_cast<unsigned char>(*pos) >= 0x80);
+    }
+}
+
+/// Reads the continuation bytes of the UTF-8 sequence starting with `lead`
+/// from a stream and appends the sequence to `str`
+template<typename IStream>
+bool GetUtf8Sequence(std::string& str, int lead, IStream& istream)
+{
+    auto sequence = utf8_leads[static_cast<unsigned char>(lead)];
+    if (sequence.length == 0)
+        return Fail(istream, ErrorCode::InvalidUtf8, lead, true);
+    str += static_cast<char>(lead);
+    for (std::size_t i = 1; i < sequence.length; ++i)
+    {
+        auto ch = istream.peek();
+        if (ch == EOF)
+            return Fail(istream, ErrorCode::UnexpectedEof);
+        if (ch < (i == 1 ? sequence.low : 0x80) || ch > (i == 1 ? sequence.high : 0xBF))
+            return Fail(istream, ErrorCode::InvalidUtf8, ch);
+        str += static_cast<char>(istream.get());
+    }
+    return true;
+}
+
+/// Reads a string from the buffer without copying it if it contains no escapes.
+/// Otherwise it is unescaped into `reader.scratch`.
+template<typename THandler>
+bool GetStringView(THandler& handler, BufferReader& reader, std::string_view& str)
+{
+    if (!Expect('"', handler, reader))
+        return false;
+
+    auto start = reader.pos;
+    auto run_end = ScanString(reader, start);
+    if (run_end == nullptr)
+        return false;
+    if (run_end != reader.end && *run_end == '"')
+    {
+        reader.pos = run_end + 1;
+        str = {start, run_end};
+        return true;
+    }
+
+    // Copy runs of plain characters in bulk, only stopping for escapes.
+    // Multibyte sequences cannot span runs, which end at ASCII characters.
+    auto& scratch = reader.scratch;
+    scratch.assign(start, run_end);
+    reader.pos = run_end;
+    while (true)
+    {
+        auto ch = reader.get();
+        if (ch == '"')
+            break;
+        if (ch == EOF)
+            return Fail(reader, ErrorCode::UnexpectedEof);
+        if (ch != '\\')
+            return Fail(reader, ErrorCode::ControlCharacter, ch, true);
+        if (!GetEscape(scratch, handler, reader))
+            return false;
+
+        run_end = ScanString(reader, reader.pos);
+        if (run_end == nullptr)
+            return false;
+        scratch.append(reader.pos, run_end);
+        reader.pos = run_end;
+    }
+    str = scratch;
+    return true;
+}
+
+template<typename THandler, typename IStream>
+bool GetEscapedString(THandler& handler, IStream& istream, std::string& str)
+{
+    if constexpr (IsBufferReader<IStream>)
+    {
+        std::string_view view;
+        if (!GetStringView(handler, istream, view))
+            return false;
+        str = view;
+        return true;
+    }
+
+    if (!Expect('"', handler, istream))
+        return false;
+    auto ch = istream.get();
+    while (ch != '"')
+    {
+        if (ch == '\\')
+        {
+            if (!GetEscape(str, handler, istream))
+                return false;
+        }
+        else if (ch >= 0 && ch < 0x20)
+        {
+            return Fail(istream, ErrorCode::ControlCharacter, ch, true);
+        }
+        else if (ch >= 0x80 && istream.validate_utf8)
+        {
+            if (!GetUtf8Sequence(str, ch, istream))
+                return false;
+        }
+        else if (!AddToString(str, ch, istream))
+        {
+            return false;
+        }
+        ch = istream.get();
+    }
+    return true;
+}
+
+template<typename THandler, typename IStream>
+bool ParseJson(
+    THandler& handler, IStream& istream, const ParseOptions& options)
+{
+    istream.validate_utf8 = options.validate_utf8;
+    if (!ParseElement(handler, istream, options))
+        return false;
+    if (auto ch = istream.peek(); ch != EOF)
+        return Fail(istream, ErrorCode::TrailingCharacters, ch);
+    return true;
+}
+
+template<typename THandler, typename IStream>
+bool ParseElement(
+    THandler& handler, IStream& istream, const ParseOptions& options)
+{
+    ContainerStack stack;
+    // Set when the handler returned Control::Skip for the key of a member
+    bool skip_value = false;
+
+    while (true)
+    {
+        // Parse a value, or open a container and continue with its first value
+        SkipWhitespace(handler, istream);
+        auto ch = istream.peek();
+        if (skip_value)
+        {
+            skip_value = false;
+            if (!SkipValue(handler, istream))
+                return false;
+        }
+        else if (ch == '{' || ch == '[')
+        {
+            if (stack.size() == options.max_depth)
+                return Fail(istream, ErrorCode::DepthExceeded);
+            istream.get();
+            auto is_object = ch == '{';
+            auto control = is_object ? Emit(istream, [&] { return handler.StartObject(); })
+                                     : Emit(istream, [&] { return handler.StartArray(); });
+            if (control == Control::Stop)
+                return false;
+            if (control == Control::Skip)
+            {
+                if (!SkipValue(handler, istream, 1))
+                    return false;
+            }
+            else
+            {
+                SkipWhitespace(handler, istream);
+                if (istream.peek() != (is_object ? '}' : ']'))
+                {
+                    stack.push(is_object);
+                    if (is_object)
+                    {
+                        control = ParseKey(handler, istream, options);
+                        if (control == Control::Stop)
+                            return false;
+                        skip_value = control == Control::Skip;
+                    }
+                    continue;
+                }
+                istream.get();
+                control = is_object ? Emit(istream, [&] { return handler.FinishObject(); })
+                                    : Emit(istream, [&] { return handler.FinishArray(); });
+                if (control == Control::Stop)
+                    return false;
+            }
+        }
+        else if (!ParseValue(handler, istream))
+        {
+            return false;
+        }
+
+        // After a value: either the next member or element follows, or the
+        // enclosing container is closed
+        while (true)
+        {
+            SkipWhitespace(handler, istream);
+            if (stack.empty())
+                return true;
+
+            ch = istream.get();
+            if (ch == ',')
+            {
+                if (stack.top())
+                {
+                    auto control = ParseKey(handler, istream, options);
+                    if (control == Control::Stop)
+                        return false;
+                    skip_value = control == Control::Skip;
+                }
+                break;
+            }
+            auto control = Control::Continue;
+            if (stack.top() && ch == '}')
+                control = Emit(istream, [&] { return handler.FinishObject(); });
+            else if (!stack.top() && ch == ']')
+                control = Emit(istream, [&] { return handler.FinishArray(); });
+            else
+                return Unexpected(istream, ch, true);
+            if (control == Control::Stop)
+                return false;
+            stack.pop();
+        }
+    }
+}
+
+template<typename THandler, typename IStream>
+bool ParseValue(THandler& handler, IStream& istream)
+{
+    switch (istream.peek())
+    {
+        case '"': return ParseString(handler, istream);
+        case '-': [[fallthrough]];
+        case '0': [[fallthrough]];
+        case '1': [[fallthrough]];
+        case '2': [[fallthrough]];
+        case '3': [[fallthrough]];
+        case '4': [[fallthrough]];
+        case '5': [[fallthrough]];
+        case '6': [[fallthrough]];
+        case '7': [[fallthrough]];
+        case '8': [[fallthrough]];
+        case '9': return ParseNumber(handler, istream);
+        case 't': [[fallthrough]];
+        case 'f': return ParseBoolLiteral(handler, istream);
+        case 'n': return ParseNull(handler, istream);
+        default: return Unexpected(istream, istream.peek());
+    }
+}
+
+template<typename THandler, typename IStream>
+Control ParseKey(THandler& handler, IStream& istream, const ParseOptions& options)
+{
+    SkipWhitespace(handler, istream);
+    auto control = ParseKeyString(handler, istream, options);
+    if (control == Control::Stop)
+        return control;
+    SkipWhitespace(handler, istream);
+    return Expect(':', handler, istream) ? control : Control::Stop;
+}
+
+template<typename THandler, typename IStream>
+Control ParseKeyString(
+    THandler& handler, IStream& istream, [[maybe_unused]] const ParseOptions& options)
+{
+    if constexpr (InternedKeyHandler<THandler>)
+    {
+        std::string_view key;
+        if constexpr (IsBufferReader<IStream>)
+        {
+            if (!GetStringView(handler, istream, key))
+                return Control::Stop;
+        }
+        else
+        {
+            istream.scratch.clear();
+            if (!GetEscapedString(handler, istream, istream.scratch))
+                return Control::Stop;
+            key = istream.scratch;
+        }
+        return EmitKey(handler, istream, key, options);
+    }
+    else if constexpr (IsBufferReader<IStream> && StringViewHandler<THandler>)
+    {
+        std::string_view key;
+        if (!GetStringView(handler, istream, key))
+            return Control::Stop;
+        return Emit(istream, [&] { return handler.Key(key); });
+    }
+    else
+    {
+        std::string key;
+        if (!GetEscapedString(handler, istream, key))
+            return Control::Stop;
+        return Emit(istream, [&] { return handler.Key(std::move(key)); });
+    }
+}
+
+/// string
+///     '"' characters '"'
+template<typename THandler, typename IStream>
+bool ParseString(THandler& handler, IStream& istream)
+{
+    if constexpr (IsBufferReader<IStream> && StringViewHandler<THandler>)
+    {
+        std::string_view str;
+        if (!GetStringView(handler, istream, str))
+            return false;
+        return Emit(istream, [&] { return handler.String(str); }) != Control::Stop;
+    }
+    else
+    {
+        std::string str;
+        if (!GetEscapedString(handler, istream, str))
+            return false;
+        return Emit(istream, [&] { return handler.String(std::move(str)); })
+            != Control::Stop;
+    }
+}
+
+/// Characters of a number read from a stream, kept for the rare conversions
+/// that fall back to std::from_chars. Short numbers never leave the inline
+/// storage.
+class NumberLexeme
+{
+public:
+    void push_back(char c)
+    {
+        if (size < small.size())
+        {
+            small[size] = c;
+        }
+        else
+        {
+            if (size == small.size())
+                large.assign(small.data(), small.size());
+            large += c;
+        }
+        ++size;
+    }
+
+    const char* begin() const
+    {
+        return size <= small.size() ? small.data() : large.data();
+    }
+    const char* end() const { return begin() + size; }
+
+private:
+    std::array<char, 32> small;
+    std::string large;
+    std::size_t size = 0;
+};
+
+/// Powers of ten that are exactly representable as double
+constexpr std::array<double, 23> exact_powers_of_ten = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+/// number
+///     integer fraction exponent
+template<typename THandler, typename IStream>
+bool ParseNumber(THandler& handler, IStream& istream)
+{
+    // Digits are accumulated in a single pass over the input. Only numbers
+    // that cannot be converted exactly from the accumulated mantissa and
+    // exponent go through std::from_chars on the original characters.
+    [[maybe_unused]] NumberLexeme lexeme;
+    [[maybe_unused]] const char* first = nullptr;
+    if constexpr (IsBufferReader<IStream>)
+        first = istream.pos;
+
+    auto next = [&istream, &lexeme]() {
+        auto ch = istream.get();
+        if constexpr (!IsBufferReader<IStream>)
+            lexeme.push_back(static_cast<char>(ch));
+        return ch;
+    };
+    auto is_digit = [](int ch) { return ch >= '0' && ch <= '9'; };
+    auto text = [&]() {
+        if constexpr (IsBufferReader<IStream>)
+            return std::string_view(first, istream.pos);
+        else
+            return std::string_view(lexeme.begin(), lexeme.end());
+    };
+    auto error = [&] {
+        return Fail(istream, ErrorCode::InvalidNumber, istream.peek());
+    };
+
+    constexpr int max_digits = std::numeric_limits<std::uint64_t>::digits10;
+    std::uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool truncated = false;
+    const bool raw = TakesRawNumbers(handler);
+    auto accumulate = [&](int ch) {
+        if (raw)
+            return false;
+        if (digits < max_digits)
+        {
+            mantissa = mantissa * 10 + static_cast<std::uint64_t>(ch - '0');
+            if (mantissa != 0)
+                ++digits;
+            return true;
+        }
+        truncated = true;
+        return false;
+    };
+
+    bool negative = istream.peek() == '-';
+    if (negative)
+        next();
+
+    if (!is_digit(istream.peek()))
+        return error();
+    if (auto ch = next(); ch == '0')
+    {
+        if (is_digit(istream.peek()))
+            return error();
+    }
+    else
+    {
+        accumulate(ch);
+        while (is_digit(istream.peek()))
+            accumulate(next());
+    }
+
+    bool is_integer = true;
+    if (istream.peek() == '.')
+    {
+        is_integer = false;
+        next();
+        if (!is_digit(istream.peek()))
+            return error();
+        while (is_digit(istream.peek()))
+        {
+            if (accumulate(next()))
+                --exponent;
+        }
+    }
+
+    if (istream.peek() == 'e' || istream.peek() == 'E')
+    {
+        is_integer = false;
+        next();
+        bool negative_exponent = false;
+        if (istream.peek() == '+' || istream.peek() == '-')
+            negative_exponent = next() == '-';
+        if (!is_digit(istream.peek()))
+            return error();
+
+        int explicit_exponent = 0;
+        while (is_digit(istream.peek()))
+        {
+            auto digit = next() - '0';
+            // Anything this large is out of range anyway
+            if (explicit_exponent < 100000)
+                explicit_exponent = explicit_exponent * 10 + digit;
+        }
+        exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+    }
+
+    if constexpr (RawNumberHandler<THandler> && !ErasedHandler<THandler>)
+    {
+        auto number = text();
+        return Emit(istream, [&] { return handler.RawNumber(number); }) != Control::Stop;
+    }
+    else
+    {
+        if constexpr (ErasedHandler<THandler>)
+        {
+            if (raw)
+            {
+                auto number = text();
+                return Emit(istream, [&] { return handler.RawNumber(number); })
+                    != Control::Stop;
+            }
+        }
+        if (is_integer)
+        {
+            constexpr auto max = static_cast<std::uint64_t>(
+                std::numeric_limits<std::intmax_t>::max());
+            if (!truncated && mantissa <= max + (negative ? 1 : 0))
+            {
+                auto value = negative ? static_cast<std::intmax_t>(0 - mantissa)
+                                      : static_cast<std::intmax_t>(mantissa);
+                return Emit(istream, [&] { return handler.Int(value); }) != Control::Stop;
+            }
+            if constexpr (UintHandler<THandler>)
+            {
+                // The mantissa holds 19 digits, so 20-digit values are
+                // converted from the text
+                auto value = mantissa;
+                if (truncated)
+                {
+                    auto number = text();
+                    auto result =
+                        std::from_chars(number.data(), number.data() + number.size(), value);
+                    truncated = result.ec != std::errc{};
+                }
+                if (!negative && !truncated && TakesUints(handler))
+                    return Emit(istream, [&] { return handler.Uint(value); }) != Control::Stop;
+            }
+            return Fail(istream, ErrorCode::NumberOutOfRange);
+        }
+
+        // Clinger's fast path: both the mantissa and the power of ten are exact,
+        // so a single multiplication or division rounds correctly
+        if (!truncated && mantissa <= (std::uint64_t{1} << 53)
+            && exponent >= -22 && exponent <= 22)
+        {
+            auto value = static_cast<double>(mantissa);
+            if (exponent < 0)
+                value /= exact_powers_of_ten[static_cast<std::size_t>(-exponent)];
+            else
+                value *= exact_powers_of_ten[static_cast<std::size_t>(exponent)];
+            if (negative)
+                value = -value;
+            return Emit(istream, [&] { return handler.Float(value); }) != Control::Stop;
+        }
+
+        auto number = text();
+        double floating_point;
+        const auto& [ptr, ec] = std::from_chars(number.data(), number.data() + number.size(), floating_point);
+        if (ec != std::errc{})
+            return Fail(istream, ErrorCode::NumberOutOfRange);
+        return Emit(istream, [&] { return handler.Float(floating_point); }) != Control::Stop;
+    }
+}
+
+template<typename THandler, typename IStream>
+bool ParseLiteral(std::string_view literal, THandler& handler, IStream& istream)
+{
+    for (char c : literal)
+    {
+        if (!Expect(c, handler, istream))
+            return false;
+    }
+    return true;
+}
+
+template<typename THandler, typename IStream>
+bool ParseBoolLiteral(THandler& handler, IStream& istream)
+{
+    bool value = istream.peek() == 't';
+    if (!ParseLiteral(value ? "true" : "false", handler, istream))
+        return false;
+    return Emit(istream, [&] { return handler.Bool(value); }) != Control::Stop;
+}
+
+template<typename THandler, typename IStream>
+bool ParseNull(THandler& handler, IStream& istream)
+{
+    if (!ParseLiteral("null", handler, istream))
+        return false;
+    return Emit(istream, [&] { return handler.Null(); }) != Control::Stop;
+}
+
+/// Skips the rest of a string after its opening quote
+template<typename THandler, typename IStream>
+bool SkipString([[maybe_unused]] THandler& handler, IStream& istream)
+{
+    if constexpr (IsBufferReader<IStream>)
+    {
+        auto pos = istream.pos;
+        while (true)
+        {
+            pos = FindStringSpecial(pos, istream.end);
+            if (pos == istream.end)
+                break;
+            if (*pos == '"')
+            {
+                istream.pos = pos + 1;
+                return true;
+            }
+            pos += *pos == '\\' && istream.end - pos > 1 ? 2 : 1;
+        }
+        istream.pos = pos;
+        return Fail(istream, ErrorCode::UnexpectedEof);
+    }
+    else
+    {
+        while (true)
+        {
+            auto ch = istream.get();
+            if (ch == '"')
+                return true;
+            if (ch == '\\')
+                ch = istream.get();
+            if (ch == EOF)
+                return Fail(istream, ErrorCode::UnexpectedEof);
+        }
+    }
+}
+
+template<typename THandler, typename IStream>
+bool SkipValue(THandler& handler, IStream& istream, std::size_t depth)
+{
+    do
+    {
+        auto ch = istream.peek();
+        switch (ch)
+        {
+        case EOF:
+            return Fail(istream, ErrorCode::UnexpectedEof);
+        case '"':
+            istream.get();
+            if (!SkipString(handler, istream))
+                return false;
+            break;
+        case '{':
+        case '[':
+            istream.get();
+            ++depth;
+            break;
+        case '}':
+        case ']':
+            if (depth == 0)
+                return Unexpected(istream, ch);
+            istream.get();
+            --depth;
+            break;
+        default:
+            if (depth != 0)
+            {
+                istream.get();
+                break;
+            }
+            // A number or literal at the top: skip up to the next delimiter
+            auto is_delimiter = [](int c) {
+                return c == EOF || IsWhitespace(static_cast<char>(c)) || c == ','
+                    || c == ':' || c == '"' || c == '{' || c == '}' || c == '['
+                    || c == ']';
+            };
+            if (is_delimiter(ch))
+                return Unexpected(istream, ch);
+            while (!is_delimiter(istream.peek()))
+                istream.get();
+        }
+
+        if constexpr (IsBufferReader<IStream>)
+        {
+            if (depth != 0)
+                istream.pos = FindSkipSpecial(istream.pos, istream.end);
+        }
+    } while (depth != 0);
+    return true;
+}
+
+/// Reads a key and the following ':' without passing it to the handler. The
+/// view is valid until the next string is read.
+template<typename THandler, typename IStream>
+bool ReadKey(
+    THandler& handler, IStream& istream, std::string_view& key,
+    [[maybe_unused]] std::string& storage)
+{
+    SkipWhitespace(handler, istream);
+    if constexpr (IsBufferReader<IStream>)
+    {
+        if (!GetStringView(handler, istream, key))
+            return false;
+    }
+    else
+    {
+        storage.clear();
+        if (!GetEscapedString(handler, istream, storage))
+            return false;
+        key = storage;
+    }
+    SkipWhitespace(handler, istream);
+    return Expect(':', handler, istream);
+}
+
+template<typename THandler, typename IStream>
+Control EmitKey(
+    THandler& handler, IStream& istream, std::string_view key,
+    [[maybe_unused]] const ParseOptions& options)
+{
+    if constexpr (InternedKeyHandler<THandler>)
+    {
+        if constexpr (ErasedHandler<THandler>)
+        {
+            if (handler.Callbacks().Interned == nullptr)
+                return Emit(istream, [&] { return handler.Key(key); });
+        }
+        auto hash = KeyHash(key);
+        auto interned = options.keys != nullptr ? options.keys->Intern(key, hash)
+                                                : InternedKey{KeyTable::none, hash, key};
+        return Emit(istream, [&] { return handler.Key(interned); });
+    }
+    else if constexpr (StringViewHandler<THandler>)
+        return Emit(istream, [&] { return handler.Key(key); });
+    else
+        return Emit(istream, [&] { return handler.Key(std::string(key)); });
+}
+
+/// Parses the value at `node` of `projection`, which is either selected or a
+/// container on the way to selected values. Anything in it that is not
+/// selected is skipped.
+///
+/// Recurses once per level of the projection, so the depth of the call stack
+/// is bounded by the longest pointer and not by the input.
+template<typename THandler, typename IStream>
+bool ParseProjectedValue(
+    THandler& handler, IStream& istream, const Projection& projection,
+    std::uint32_t node, std::size_t depth, const ParseOptions& options)
+{
+    if (projection.Selected(node))
+    {
+        auto remaining = options;
+        remaining.max_depth -= depth;
+        return ParseElement(handler, istream, remaining);
+    }
+    if (depth == options.max_depth)
+        return Fail(istream, ErrorCode::DepthExceeded);
+
+    auto is_object = istream.get() == '{';
+    auto control = is_object ? Emit(istream, [&] { return handler.StartObject(); })
+                             : Emit(istream, [&] { return handler.StartArray(); });
+    if (control == Control::Stop)
+        return false;
+    if (control == Control::Skip)
+        return SkipValue(handler, istream, 1);
+
+    SkipWhitespace(handler, istream);
+    if (istream.peek() == (is_object ? '}' : ']'))
+    {
+        istream.get();
+    }
+    else
+    {
+        std::string storage;
+        std::string_view key;
+        std::size_t index = 0;
+        int ch;
+        do
+        {
+            auto child = Projection::none;
+            if (is_object)
+            {
+                if (!ReadKey(handler, istream, key, storage))
+                    return false;
+                child = projection.Child(node, key);
+            }
+            else
+            {
+                child = projection.Child(node, index++);
+            }
+
+            // Containers on the way to selected values are entered even if
+            // nothing in them turns out to be selected
+            SkipWhitespace(handler, istream);
+            ch = istream.peek();
+            if (child != Projection::none
+                && (projection.Selected(child) || ch == '{' || ch == '['))
+            {
+                control = is_object ? EmitKey(handler, istream, key, options)
+                                    : Control::Continue;
+                if (control == Control::Stop)
+                    return false;
+            }
+            else
+            {
+                control = Control::Skip;
+            }
+
+            if (control == Control::Skip)
+            {
+                if (!SkipValue(handler, istream))
+                    return false;
+            }
+            else if (!ParseProjectedValue(handler, istream, projection, child, depth + 1, options))
+            {
+                return false;
+            }
+
+            SkipWhitespace(handler, istream);
+            ch = istream.get();
+        } while (ch == ',');
+
+        if (ch != (is_object ? '}' : ']'))
+            return Unexpected(istream, ch, true);
+    }
+
+    control = is_object ? Emit(istream, [&] { return handler.FinishObject(); })
+                        : Emit(istream, [&] { return handler.FinishArray(); });
+    return control != Control::Stop;
+}
+
+template<typename THandler, typename IStream>
+bool ParseProjectedJson(
+    THandler& handler, IStream& istream, const Projection& projection,
+    const ParseOptions& options)
+{
+    istream.validate_utf8 = options.validate_utf8;
+    SkipWhitespace(handler, istream);
+    auto ch = istream.peek();
+    if (projection.Selected(Projection::root) || ch == '{' || ch == '[')
+    {
+        if (!ParseProjectedValue(handler, istream, projection, Projection::root, 0, options))
+            return false;
+    }
+    else if (!SkipValue(handler, istream))
+    {
+        return false;
+    }
+
+    SkipWhitespace(handler, istream);
+    if (ch = istream.peek(); ch != EOF)
+        return Fail(istream, ErrorCode::TrailingCharacters, ch);
+    return true;
+}
+
+}
+
+/// Parses the JSON document read from `istream`.
+///
+/// Parsing stops at the first error, which is returned and, if the handler
+/// has an `Error` callback, reported to `handler.Error`.
+template<typename THandler, typename IStream = std::istream>
+    requires(!std::convertible_to<IStream&, std::string_view>)
+ParseResult Parse(
+    THandler& handler, IStream& istream, const ParseOptions& options = {})
+{
+    detail::StreamReader<IStream> reader{istream};
+    detail::ParseJson(handler, reader, options);
+    return detail::Report(handler, reader.Result());
+}
+
+/// Parses the JSON document in [begin, end).
+///
+/// This is the fast path: the parser works on the raw memory instead of going
+/// through `peek()`/`get()` for every character.
+template<typename THandler>
+ParseResult Parse(
+    THandler& handler, const char* begin, const char* end,
+    const ParseOptions& options = {})
+{
+    detail::BufferReader reader{begin, end};
+    detail::ParseJson(handler, reader, options);
+    return detail::Report(handler, reader.Result());
+}
+
+template<typename THandler>
+ParseResult Parse(
+    THandler& handler, std::string_view json, const ParseOptions& options = {})
+{
+    return Parse(handler, json.data(), json.data() + json.size(), options);
+}
+
+/// Parses only the values of the document read from `istream` that are
+/// selected by `projection`, skipping everything else.
+template<typename THandler, typename IStream = std::istream>
+    requires(!std::convertible_to<IStream&, std::string_view>)
+ParseResult ParseProjected(
+    THandler& handler, IStream& istream, const Projection& projection,
+    const ParseOptions& options = {})
+{
+    detail::StreamReader<IStream> reader{istream};
+    detail::ParseProjectedJson(handler, reader, projection, options);
+    return detail::Report(handler, reader.Result());
+}
+
+/// Parses only the values of `json` that are selected by `projection`,
+/// skipping everything else.
+template<typename THandler>
+ParseResult ParseProjected(
+    THandler& handler, std::string_view json, const Projection& projection,
+    const ParseOptions& options = {})
+{
+    detail::BufferReader reader{json.data(), json.data() + json.size()};
+    detail::ParseProjectedJson(handler, reader, projection, options);
+    return detail::Report(handler, reader.Result());
+}
+
+namespace detail
+{
+/// Parses the values on one line of JSON Lines input, each as a record. An
+/// error ends the line and is reported as if `reader` started at `offset` on
+/// line `line` of the input, where line 0 means unknown. Returns false if the
+/// handler stopped parsing.
+template<typename THandler>
+bool ParseLine(
+    THandler& handler, BufferReader& reader, const ParseOptions& options,
+    std::size_t offset, std::size_t line)
+{
+    reader.validate_utf8 = options.validate_utf8;
+    while (true)
+    {
+        SkipWhitespace(handler, reader);
+        if (reader.pos == reader.end)
+            return true;
+
+        if constexpr (requires { handler.StartRecord(); })
+            handler.StartRecord();
+        if (!ParseElement(handler, reader, options))
+        {
+            if (reader.stopped)
+                return false;
+
+            auto result = reader.Result();
+            result.offset += offset;
+            result.line = line;
+            if (line == 0)
+                result.column = 0;
+            Report(handler, result);
+            reader.error = ErrorCode::None;
+            return true;
+        }
+        if constexpr (requires { handler.FinishRecord(); })
+            handler.FinishRecord();
+    }
+}
+
+/// ParseLines over [begin, end), which starts at `offset` on line `line` of
+/// the whole input. Line 0 leaves lines uncounted.
+template<typename THandler>
+void ParseLines(
+    THandler& handler, const char* begin, const char* end,
+    const ParseOptions& options, std::size_t offset, std::size_t line)
+{
+    detail::BufferReader reader{begin, begin};
+    for (auto line_begin = begin; line_begin != end;)
+    {
+        auto line_end = static_cast<const char*>(std::memchr(
+            line_begin, '\n', static_cast<std::size_t>(end - line_begin)));
+        if (line_end == nullptr)
+            line_end = end;
+
+        reader.begin = reader.pos = line_begin;
+        reader.end = line_end;
+        auto line_offset = offset + static_cast<std::size_t>(line_begin - begin);
+        if (!ParseLine(handler, reader, options, line_offset, line))
+            return;
+
+        line_begin = line_end == end ? end : line_end + 1;
+        if (line != 0)
+            ++line;
+    }
+}
+} // namespace detail
+
+/// Parses newline-delimited JSON (JSON Lines) in [begin, end).
+///
+/// Every top-level value is a record, and several values may follow each
+/// other on one line. If the handler provides `StartRecord()` and
+/// `FinishRecord()` they are called around the events of each record. A
+/// malformed record is reported to `handler.Error` instead of
+/// `FinishRecord`, and parsing resumes on the next line. Control::Stop from
+/// the handler ends parsing altogether.
+template<typename THandler>
+void ParseLines(
+    THandler& handler, const char* begin, const char* end,
+    const ParseOptions& options = {})
+{
+    detail::ParseLines(handler, begin, end, options, 0, 1);
+}
+
+template<typename THandler>
+void ParseLines(
+    THandler& handler, std::string_view json, const ParseOptions& options = {})
+{
+    ParseLines(handler, json.data(), json.data() + json.size(), options);
+}
+
+/// Parses newline-delimited JSON read from `istream`, one line at a time
+template<typename THandler, typename IStream = std::istream>
+    requires(!std::convertible_to<IStream&, std::string_view>)
+void ParseLines(
+    THandler& handler, IStream& istream, const ParseOptions& options = {})
+{
+    std::string line;
+    detail::BufferReader reader{nullptr, nullptr};
+    std::size_t offset = 0;
+    for (std::size_t number = 1; std::getline(istream, line); ++number)
+    {
+        reader.begin = reader.pos = line.data();
+        reader.end = line.data() + line.size();
+        if (!detail::ParseLine(handler, reader, options, offset, number))
+            return;
+        offset += line.size() + 1;
+    }
+}
+
+/// Order in which ParseLinesParallel hands finished chunks to the caller
+enum class Delivery
+{
+    /// In the order of the chunks in the input
+    Ordered,
+    /// As soon as a chunk is finished
+    Unordered,
+};
+
+struct ParallelOptions
+{
+    /// Number of threads parsing chunks, including the calling thread. Zero
+    /// uses std::thread::hardware_concurrency().
+    std::size_t threads = 0;
+    /// Approximate size of the chunks the input is split into. Chunks always
+    /// end at a line boundary.
+    std::size_t chunk_size = std::size_t{1} << 20;
+    Delivery delivery = Delivery::Ordered;
+    ParseOptions parse{};
+};
+
+/// Parses newline-delimited JSON in parallel.
+///
+/// `json` is split into chunks at line boundaries, which are parsed with
+/// ParseLines on a pool of threads. Every chunk gets its own copy of
+/// `prototype` as handler. Once a chunk is parsed, its handler is passed to
+/// `on_chunk(THandler&& handler, std::size_t chunk_index)`, in input order or
+/// in order of completion depending on `options.delivery`. `on_chunk` is never
+/// called concurrently. The input may be any buffer, e.g. a memory-mapped file.
+///
+/// An exception thrown by a handler or `on_chunk` stops the remaining chunks
+/// and is rethrown to the caller. Control::Stop only ends the chunk of the
+/// handler returning it. A KeyTable in the options cannot be shared by the
+/// threads and throws std::invalid_argument. Errors are reported with their
+/// offset in `json`, but without line and column, which would require
+/// counting every line.
+template<typename THandler, typename OnChunk>
+void ParseLinesParallel(
+    const THandler& prototype, std::string_view json, OnChunk&& on_chunk,
+    const ParallelOptions& options = {})
+{
+    if (options.parse.keys != nullptr)
+        throw std::invalid_argument("ParseLinesParallel cannot share a KeyTable");
+
+    std::vector<std::string_view> chunks;
+    auto chunk_size = std::max<std::size_t>(options.chunk_size, 1);
+    for (std::size_t begin = 0; begin < json.size();)
+    {
+        auto end = json.find('\n', std::min(begin + chunk_size, json.size()) - 1);
+        end = end == std::string_view::npos ? json.size() : end + 1;
+        chunks.push_back(json.substr(begin, end - begin));
+        begin = end;
+    }
+
+    auto threads = options.threads != 0
+        ? options.threads
+        : std::max(std::thread::hardware_concurrency(), 1u);
+    threads = std::min(threads, chunks.size());
+
+    std::atomic<std::size_t> next_chunk{0};
+    std::atomic<bool> stop{false};
+    std::mutex mutex;
+    std::exception_ptr error;
+    // Finished chunks waiting for their predecessors when delivery is ordered
+    std::vector<std::optional<THandler>> finished(
+        options.delivery == Delivery::Ordered ? chunks.size() : 0);
+    std::size_t next_delivery = 0;
+
+    auto work = [&]() {
+        try
+        {
+            for (auto index = next_chunk++; index < chunks.size() && !stop;
+                 index = next_chunk++)
+            {
+                THandler handler(prototype);
+                auto chunk = chunks[index];
+                detail::ParseLines(
+                    handler, chunk.data(), chunk.data() + chunk.size(), options.parse,
+                    static_cast<std::size_t>(chunk.data() - json.data()), 0);
+
+                std::lock_guard lock(mutex);
+                if (options.delivery == Delivery::Unordered)
+                {
+                    on_chunk(std::move(handler), index);
+                    continue;
+                }
+
+                finished[index].emplace(std::move(handler));
+                for (; next_delivery < chunks.size() && finished[next_delivery];
+                     ++next_delivery)
+                {
+                    on_chunk(std::move(*finished[next_delivery]), next_delivery);
+                    finished[next_delivery].reset();
+                }
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard lock(mutex);
+            if (!error)
+                error = std::current_exception();
+            stop = true;
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (std::size_t i = 1; i < threads; ++i)
+        pool.emplace_back(work);
+    work();
+    for (auto& thread : pool)
+        thread.join();
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+/// Incremental parser for input that arrives in chunks, e.g. from a socket.
+///
+/// Each call to `Feed` processes as much of the chunk as possible and fires the
+/// same handler events as Parse. Strings, numbers and literals may be split
+/// across chunks at any byte; only these partial tokens are copied and kept
+/// until the rest arrives. `Finish` marks the end of the input. Both return
+/// false once an error has been reported to the handler, after which all
+/// further input is ignored, and `Result()` holds the error with its position
+/// in the whole input. After the handler returned Control::Stop, `Feed`
+/// returns false as well and ignores further input, but `Finish` returns true.
+template<typename THandler>
+class PushParser
+{
+public:
+    explicit PushParser(THandler& handler, const ParseOptions& options = {})
+        : handler(handler)
+        , options(options)
+    {
+        reader.validate_utf8 = options.validate_utf8;
+    }
+
+    bool Feed(std::span<const char> chunk)
+    {
+        chunk_begin = chunk.data();
+        bool ok = Consume(chunk.data(), chunk.data() + chunk.size());
+
+        // Remember where the next chunk starts, for the position of errors
+        auto next = Locate(chunk.data() + chunk.size());
+        chunk_offset = next.offset;
+        chunk_line = next.line;
+        chunk_line_start = next.offset - (next.column - 1);
+        chunk_begin = nullptr;
+        return ok;
+    }
+
+    bool Finish()
+    {
+        if (state == State::Failed || state == State::Stopped)
+            return state == State::Stopped;
+
+        // A number can only be known to be complete at the end of the input.
+        // Incomplete strings and literals are reported by their parse function.
+        if (token != Token::None
+            && !Dispatch(partial.data(), partial.data() + partial.size()))
+            return false;
+
+        if (state != State::AfterValue || !stack.empty())
+            return Fail(ErrorCode::UnexpectedEof, chunk_begin);
+        return true;
+    }
+
+    /// The error that ended parsing, if any
+    const ParseResult& Result() const { return result; }
+
+private:
+    enum class State
+    {
+        Value,
+        FirstValue, ///< Value or ']' of an empty array
+        Key,
+        FirstKey, ///< Key or '}' of an empty object
+        Colon,
+        AfterValue,
+        /// Inside a container the handler skipped
+        Skipping,
+        Failed,
+        /// The handler returned Control::Stop
+        Stopped,
+    };
+    enum class Token
+    {
+        None,
+        String,
+        Number,
+        Literal,
+    };
+
+    bool Consume(const char* pos, const char* end)
+    {
+        if (token != Token::None)
+        {
+            auto token_end = ScanToken(pos, end);
+            partial.append(pos, token_end);
+            if (token_end == end && !token_complete)
+                return state != State::Failed;
+            pos = token_end;
+            if (!Dispatch(partial.data(), partial.data() + partial.size()))
+                return false;
+        }
+
+        while (state != State::Failed && state != State::Stopped)
+        {
+            pos = state == State::Skipping ? Skip(pos, end)
+                                           : detail::FindNonWhitespace(pos, end);
+            if (pos == end)
+                break;
+            if (state != State::Skipping)
+                pos = Step(pos, end);
+        }
+        return state != State::Failed && state != State::Stopped;
+    }
+
+    /// Processes the token or structural character at `pos`, which is not
+    /// whitespace, and returns where to continue
+    const char* Step(const char* pos, const char* end)
+    {
+        auto c = *pos;
+        switch (state)
+        {
+        case State::FirstValue:
+            if (c == ']')
+                return Close(pos, false);
+            [[fallthrough]];
+        case State::Value:
+            if (c == '{' || c == '[')
+            {
+                auto control = Control::Skip;
+                if (!skip_value)
+                {
+                    if (stack.size() == options.max_depth)
+                        return FailAt(end, ErrorCode::DepthExceeded, pos);
+                    control = c == '{'
+                        ? detail::Emit(reader, [&] { return handler.StartObject(); })
+                        : detail::Emit(reader, [&] { return handler.StartArray(); });
+                }
+                skip_value = false;
+                if (control == Control::Stop)
+                {
+                    state = State::Stopped;
+                    return end;
+                }
+                if (control == Control::Skip)
+                {
+                    state = State::Skipping;
+                    skip_depth = 1;
+                    skip_in_string = false;
+                    escape_pending = false;
+                    return pos + 1;
+                }
+                stack.push(c == '{');
+                state = c == '{' ? State::FirstKey : State::FirstValue;
+                return pos + 1;
+            }
+            if (c == '"')
+                return StartToken(Token::String, false, pos, end);
+            if (c == '-' || (c >= '0' && c <= '9'))
+                return StartToken(Token::Number, false, pos, end);
+            if (c == 't' || c == 'f' || c == 'n')
+                return StartToken(Token::Literal, false, pos, end);
+            return FailAt(end, ErrorCode::UnexpectedCharacter, pos);
+        case State::FirstKey:
+            if (c == '}')
+                return Close(pos, true);
+            [[fallthrough]];
+        case State::Key:
+            if (c == '"')
+                return StartToken(Token::String, true, pos, end);
+            return FailAt(end, ErrorCode::UnexpectedCharacter, pos);
+        case State::Colon:
+            if (c == ':')
+            {
+                state = State::Value;
+                return pos + 1;
+            }
+            return FailAt(end, ErrorCode::UnexpectedCharacter, pos);
+        case State::AfterValue:
+            if (!stack.empty() && c == ',')
+            {
+                state = stack.top() ? State::Key : State::Value;
+                return pos + 1;
+            }
+            if (!stack.empty() && c == (stack.top() ? '}' : ']'))
+                return Close(pos, stack.top());
+            return FailAt(
+                end,
+                stack.empty() ? ErrorCode::TrailingCharacters
+                              : ErrorCode::UnexpectedCharacter,
+                pos);
+        case State::Skipping:
+        case State::Failed:
+        case State::Stopped: break;
+        }
+        return end;
+    }
+
+    const char* Close(const char* pos, bool is_object)
+    {
+        auto control = is_object
+            ? detail::Emit(reader, [&] { return handler.FinishObject(); })
+            : detail::Emit(reader, [&] { return handler.FinishArray(); });
+        stack.pop();
+        state = control == Control::Stop ? State::Stopped : State::AfterValue;
+        return pos + 1;
+    }
+
+    /// Skips over the contents of a skipped container in [pos, end) by
+    /// matching quotes and brackets, and returns where to continue
+    const char* Skip(const char* pos, const char* end)
+    {
+        while (pos != end)
+        {
+            if (skip_in_string)
+            {
+                if (escape_pending)
+                {
+                    escape_pending = false;
+                    ++pos;
+                    continue;
+                }
+                pos = detail::FindStringSpecial(pos, end);
+                if (pos == end)
+                    break;
+                if (*pos == '"')
+                    skip_in_string = false;
+                else if (*pos == '\\')
+                    escape_pending = true;
+                ++pos;
+                continue;
+            }
+
+            pos = detail::FindSkipSpecial(pos, end);
+            if (pos == end)
+                break;
+            auto c = *pos++;
+            if (c == '"')
+            {
+                skip_in_string = true;
+            }
+            else if (c == '{' || c == '[')
+            {
+                ++skip_depth;
+            }
+            else if (--skip_depth == 0)
+            {
+                state = State::AfterValue;
+                return pos;
+            }
+        }
+        return end;
+    }
+
+    /// Parses the token at `pos` directly from the chunk if it is complete,
+    /// otherwise keeps it until the next Feed
+    const char* StartToken(Token kind, bool key, const char* pos, const char* end)
+    {
+        token = kind;
+        token_is_key = key;
+        token_complete = false;
+        escape_pending = false;
+        partial.clear();
+
+        auto token_end = ScanToken(kind == Token::String ? pos + 1 : pos, end);
+        if (token_end == end && !token_complete)
+        {
+            partial.assign(pos, end);
+            token_start = Locate(pos);
+            return end;
+        }
+        Dispatch(pos, token_end);
+        return token_end;
+    }
+
+    /// Returns the end of the current token in [pos, end), setting
+    /// `token_complete` if it ends before `end`
+    const char* ScanToken(const char* pos, const char* end)
+    {
+        auto is_number_char = [](char c) {
+            return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.'
+                || c == 'e' || c == 'E';
+        };
+
+        switch (token)
+        {
+        case Token::String:
+            if (escape_pending && pos != end)
+            {
+                escape_pending = false;
+                ++pos;
+            }
+            while (true)
+            {
+                pos = detail::FindStringSpecial(pos, end);
+                if (pos == end)
+                    return end;
+                if (*pos == '"')
+                {
+                    token_complete = true;
+                    return pos + 1;
+                }
+                if (*pos == '\\' && ++pos == end)
+                {
+                    escape_pending = true;
+                    return end;
+                }
+                // Skip the escaped character, or the control character which
+                // is reported when the string is parsed
+                ++pos;
+            }
+        case Token::Number:
+            while (pos != end && is_number_char(*pos))
+                ++pos;
+            break;
+        case Token::Literal:
+            while (pos != end && *pos >= 'a' && *pos <= 'z')
+                ++pos;
+            break;
+        case Token::None: break;
+        }
+        token_complete = pos != end;
+        if (token_complete)
+            token_terminator = *pos;
+        return pos;
+    }
+
+    /// Parses the complete token in [begin, end)
+    bool Dispatch(const char* begin, const char* end)
+    {
+        auto kind = token;
+        token = Token::None;
+        if (skip_value && !token_is_key)
+        {
+            skip_value = false;
+            state = State::AfterValue;
+            return true;
+        }
+
+        reader.begin = reader.pos = begin;
+        reader.end = end;
+        bool ok = false;
+        switch (kind)
+        {
+        case Token::String:
+            if (token_is_key)
+            {
+                auto control = detail::ParseKeyString(handler, reader, options);
+                skip_value = control == Control::Skip;
+                ok = control != Control::Stop;
+            }
+            else
+            {
+                ok = detail::ParseString(handler, reader);
+            }
+            break;
+        case Token::Number: ok = detail::ParseNumber(handler, reader); break;
+        case Token::Literal:
+            ok = *begin == 'n' ? detail::ParseNull(handler, reader)
+                               : detail::ParseBoolLiteral(handler, reader);
+            break;
+        case Token::None: break;
+        }
+
+        if (!ok && reader.stopped)
+        {
+            state = State::Stopped;
+            return false;
+        }
+        if (ok && reader.pos != end)
+        {
+            // Like "1-5" or "truex", which the other parsers only reject
+            // after the value
+            ok = stack.empty() && !token_is_key
+                ? detail::Fail(reader, ErrorCode::TrailingCharacters, reader.peek())
+                : detail::Unexpected(reader, reader.peek());
+        }
+        if (!ok && reader.error_pos == end && token_complete && kind != Token::String)
+        {
+            // A token cut short like "[nul]" ends at the character after it,
+            // not at the end of the input. Numbers out of range have no
+            // offending character.
+            if (reader.error == ErrorCode::UnexpectedEof)
+                reader.error = ErrorCode::UnexpectedCharacter;
+            if (reader.error != ErrorCode::NumberOutOfRange)
+                reader.error_character = token_terminator;
+        }
+        if (!ok)
+        {
+            // Locate the error in the token relative to the start of the token
+            auto in_token = reader.Result();
+            result = begin == partial.data() ? token_start : Locate(begin);
+            result.code = in_token.code;
+            result.character = in_token.character;
+            result.offset += in_token.offset;
+            if (in_token.line == 1)
+            {
+                result.column += in_token.column - 1;
+            }
+            else
+            {
+                result.line += in_token.line - 1;
+                result.column = in_token.column;
+            }
+            reader.error = ErrorCode::None;
+            state = State::Failed;
+            detail::Report(handler, result);
+            return false;
+        }
+        state = token_is_key ? State::Colon : State::AfterValue;
+        return true;
+    }
+
+    /// Returns the position of `pos` in the current chunk within the whole
+    /// input, counting the lines from the start of the chunk
+    ParseResult Locate(const char* pos) const
+    {
+        ParseResult position;
+        position.offset = chunk_offset + static_cast<std::size_t>(pos - chunk_begin);
+        position.line = chunk_line;
+        auto line_start = chunk_line_start;
+        for (auto newline = chunk_begin;
+             newline != pos
+             && (newline = static_cast<const char*>(std::memchr(
+                     newline, '\n', static_cast<std::size_t>(pos - newline))));
+             ++newline)
+        {
+            ++position.line;
+            line_start = chunk_offset + static_cast<std::size_t>(newline - chunk_begin) + 1;
+        }
+        position.column = position.offset - line_start + 1;
+        return position;
+    }
+
+    /// Fails on the character at `pos` in the current chunk, or at the end of
+    /// the input if `pos` is null
+    bool Fail(ErrorCode code, const char* pos)
+    {
+        result = Locate(pos);
+        result.code = code;
+        if (pos != nullptr && code != ErrorCode::UnexpectedEof)
+            result.character = *pos;
+        state = State::Failed;
+        detail::Report(handler, result);
+        return false;
+    }
+    const char* FailAt(const char* end, ErrorCode code, const char* pos)
+    {
+        Fail(code, pos);
+        return end;
+    }
+
+    THandler& handler;
+    ParseOptions options;
+    State state = State::Value;
+    detail::ContainerStack stack;
+    detail::BufferReader reader{nullptr, nullptr};
+
+    Token token = Token::None;
+    bool token_is_key = false;
+    bool token_complete = false;
+    /// The character after a complete number or literal, which may be in the
+    /// next chunk
+    char token_terminator = 0;
+    bool escape_pending = false;
+
+    /// Set when the handler returned Control::Skip for the key of a member
+    bool skip_value = false;
+    /// Open brackets and whether inside a string, in State::Skipping
+    std::size_t skip_depth = 0;
+    bool skip_in_string = false;
+    /// Start of a token that was not complete at the end of the last chunk
+    std::string partial;
+    /// Position of the token in `partial`
+    ParseResult token_start;
+
+    /// Position of the current chunk in the input, and where its first line
+    /// starts
+    const char* chunk_begin = nullptr;
+    std::size_t chunk_offset = 0;
+    std::size_t chunk_line = 1;
+    std::size_t chunk_line_start = 0;
+    ParseResult result;
+};
+
+/// Parses the JSON file at `path`.
+///
+/// Regular files are memory-mapped and parsed in place with the buffer parser.
+/// Pipes and other files that cannot be mapped are read in chunks and fed to a
+/// PushParser, so they are never buffered as a whole either. Failing to open
+/// or read the file is an ErrorCode::IoError.
+template<typename THandler>
+ParseResult ParseFile(
+    THandler& handler, const std::filesystem::path& path,
+    const ParseOptions& options = {})
+{
+    auto io_error = [&handler] {
+        ParseResult result;
+        result.code = ErrorCode::IoError;
+        result.system_error = errno;
+        return detail::Report(handler, result);
+    };
+    auto read_chunks = [&handler, &options, &io_error](auto&& read) {
+        PushParser parser{handler, options};
+        std::array<char, 65536> chunk;
+        while (auto size = read(chunk.data(), chunk.size()))
+        {
+            if (size < 0)
+                return io_error();
+            if (!parser.Feed({chunk.data(), static_cast<std::size_t>(size)}))
+                return parser.Result();
+        }
+        parser.Finish();
+        return parser.Result();
+    };
+
+#ifdef SAXY_JSON_POSIX
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return io_error();
+
+    struct stat info;
+    if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode))
+    {
+        auto size = static_cast<std::size_t>(info.st_size);
+        if (size == 0)
+        {
+            ::close(fd);
+            return Parse(handler, std::string_view(), options);
+        }
+
+        if (auto data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            data != MAP_FAILED)
+        {
+            ::close(fd);
+            ::madvise(data, size, MADV_SEQUENTIAL);
+            struct Unmap
+            {
+                void* data;
+                std::size_t size;
+                ~Unmap() { ::munmap(data, size); }
+            } unmap{data, size};
+
+            auto begin = static_cast<const char*>(data);
+            return Parse(handler, begin, begin + size, options);
+        }
+    }
+
+    struct Close
+    {
+        int fd;
+        ~Close() { ::close(fd); }
+    } close{fd};
+    return read_chunks([fd](char* buffer, std::size_t size) {
+        ssize_t result;
+        do
+            result = ::read(fd, buffer, size);
+        while (result < 0 && errno == EINTR);
+        return result;
+    });
+#else
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return io_error();
+    return read_chunks([&file](char* buffer, std::size_t size) {
+        file.read(buffer, static_cast<std::streamsize>(size));
+        return file.bad() ? std::streamsize{-1} : file.gcount();
+    });
+#endif
+}
+
+namespace detail
+{
+/// Monotonic allocator behind Document. Memory is handed out from a chain of
+/// blocks, each at least twice as large as the one before, and is only ever
+/// released as a whole.
+class Arena
+{
+public:
+    Arena() = default;
+    Arena(const Arena&) = delete;
+    Arena(Arena&& other) noexcept
+        : head(std::exchange(other.head, nullptr))
+        , pos(std::exchange(other.pos, nullptr))
+        , end(std::exchange(other.end, nullptr))
+    {}
+    Arena& operator=(const Arena&) = delete;
+    Arena& operator=(Arena&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Release();
+            head = std::exchange(other.head, nullptr);
+            pos = std::exchange(other.pos, nullptr);
+            end = std::exchange(other.end, nullptr);
+        }
+        return *this;
+    }
+    ~Arena() { Release(); }
+
+    /// Returns `size` bytes aligned to `align`, which is a power of two no
+    /// larger than alignof(std::max_align_t)
+    void* Allocate(std::size_t size, std::size_t align)
+    {
+        auto aligned = (reinterpret_cast<std::uintptr_t>(pos) + align - 1) & ~(align - 1);
+        if (head == nullptr || aligned > reinterpret_cast<std::uintptr_t>(end)
+            || size > reinterpret_cast<std::uintptr_t>(end) - aligned)
+        {
+            Grow(size);
+            aligned = reinterpret_cast<std::uintptr_t>(pos);
+        }
+        pos = reinterpret_cast<char*>(aligned + size);
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    /// Frees everything at once. Keeps the newest block, which is the largest,
+    /// if it has room for `capacity` bytes.
+    void Reset(std::size_t capacity)
+    {
+        if (head != nullptr && head->size >= capacity)
+        {
+            auto newest = std::exchange(head, head->previous);
+            Release();
+            newest->previous = nullptr;
+            head = newest;
+            pos = reinterpret_cast<char*>(head + 1);
+            end = pos + head->size;
+        }
+        else
+        {
+            Release();
+            Grow(capacity);
+        }
+    }
+
+private:
+    struct Block
+    {
+        Block* previous;
+        std::size_t size;
+    };
+    static_assert(sizeof(Block) % alignof(std::max_align_t) == 0);
+
+    static constexpr std::size_t min_block_size = 4096;
+
+    void Grow(std::size_t size)
+    {
+        size = std::max({size, head != nullptr ? head->size * 2 : 0, min_block_size});
+        auto block = static_cast<Block*>(::operator new(sizeof(Block) + size));
+        block->previous = head;
+        block->size = size;
+        head = block;
+        pos = reinterpret_cast<char*>(block + 1);
+        end = pos + size;
+    }
+
+    void Release()
+    {
+        while (head != nullptr)
+            ::operator delete(std::exchange(head, head->previous));
+        pos = end = nullptr;
+    }
+
+    Block* head = nullptr;
+    char* pos = nullptr;
+    char* end = nullptr;
+};
+
+class DocumentBuilder;
+} // namespace detail
+
+enum class ValueType : std::uint8_t
+{
+    Null,
+    Bool,
+    Int,
+    Float,
+    String,
+    Array,
+    Object,
+};
+
+struct Member;
+
+/// A value in a Document, 16 bytes in size.
+///
+/// Strings, elements and members live in the arena of the Document (or, for
+/// borrowed strings, in the input), so a Value is only valid as long as its
+/// Document. Accessing a value as the wrong type throws std::invalid_argument.
+class Value
+{
+public:
+    /// Objects with more members than this get a sorted index for lookups
+    static constexpr std::size_t indexed_size = 16;
+
+    Value() = default;
+
+    ValueType Type() const { return type; }
+    bool IsNull() const { return type == ValueType::Null; }
+    bool IsBool() const { return type == ValueType::Bool; }
+    bool IsInt() const { return type == ValueType::Int; }
+    bool IsFloat() const { return type == ValueType::Float; }
+    bool IsNumber() const { return IsInt() || IsFloat(); }
+    bool IsString() const { return type == ValueType::String; }
+    bool IsArray() const { return type == ValueType::Array; }
+    bool IsObject() const { return type == ValueType::Object; }
+
+    bool Bool() const
+    {
+        Expect(ValueType::Bool);
+        return boolean;
+    }
+    std::intmax_t Int() const
+    {
+        Expect(ValueType::Int);
+        return integer;
+    }
+    /// The value of a number, converting integers
+    double Float() const
+    {
+        if (type == ValueType::Int)
+            return static_cast<double>(integer);
+        Expect(ValueType::Float);
+        return number;
+    }
+    std::string_view String() const
+    {
+        Expect(ValueType::String);
+        return {string, size};
+    }
+
+    std::span<const Value> Elements() const
+    {
+        Expect(ValueType::Array);
+        return {elements, size};
+    }
+    std::span<const Member> Members() const;
+
+    /// Number of elements or members, and zero for any other value
+    std::size_t Size() const
+    {
+        return type == ValueType::Array || type == ValueType::Object ? size : 0;
+    }
+
+    /// Throws std::out_of_range if the array has no element `index`
+    const Value& operator[](std::size_t index) const
+    {
+        auto values = Elements();
+        if (index >= values.size())
+            throw std::out_of_range("Array index out of range: " + std::to_string(index));
+        return values[index];
+    }
+    /// Throws std::out_of_range if the object has no member `key`
+    const Value& operator[](std::string_view key) const;
+
+    /// The value of the first member named `key`, or null if there is none
+    /// or this is not an object
+    const Value* Find(std::string_view key) const;
+
+private:
+    friend class detail::DocumentBuilder;
+
+    void Expect(ValueType expected) const
+    {
+        static constexpr std::array<const char*, 7> names = {
+            "null", "bool", "int", "float", "string", "array", "object"};
+        if (type != expected)
+        {
+            throw std::invalid_argument(
+                std::string("Expected ") + names[static_cast<std::size_t>(expected)]
+                + " but value is " + names[static_cast<std::size_t>(type)]);
+        }
+    }
+
+    ValueType type = ValueType::Null;
+    std::uint32_t size = 0;
+    union
+    {
+        bool boolean;
+        std::intmax_t integer = 0;
+        double number;
+        const char* string;
+        const Value* elements;
+        const Member* members;
+    };
+};
+
+struct Member
+{
+    std::string_view key;
+    Value value;
+};
+
+inline std::span<const Member> Value::Members() const
+{
+    Expect(ValueType::Object);
+    return {members, size};
+}
+
+inline const Value* Value::Find(std::string_view key) const
+{
+    if (type != ValueType::Object)
+        return nullptr;
+
+    if (size > indexed_size)
+    {
+        // Member positions sorted by key, stored after the members
+        auto index = reinterpret_cast<const std::uint32_t*>(members + size);
+        auto found = std::lower_bound(
+            index, index + size, key,
+            [this](std::uint32_t i, std::string_view key) { return members[i].key < key; });
+        if (found != index + size && members[*found].key == key)
+            return &members[*found].value;
+        return nullptr;
+    }
+
+    for (auto& member : std::span(members, size))
+    {
+        if (member.key == key)
+            return &member.value;
+    }
+    return nullptr;
+}
+
+inline const Value& Value::operator[](std::string_view key) const
+{
+    Expect(ValueType::Object);
+    if (auto value = Find(key))
+        return *value;
+    throw std::out_of_range("No member '" + std::string(key) + "'");
+}
+
+namespace detail
+{
+/// Handler building a Document. Values of open containers are collected on a
+/// stack, and copied to contiguous memory in the arena once the container is
+/// finished. Every open container has a placeholder member on the stack,
+/// which keeps its key until its value is known.
+class DocumentBuilder
+{
+public:
+    /// Strings within `borrowed` are referenced instead of copied
+    DocumentBuilder(
+        Arena& arena, std::vector<Member>& pending, std::vector<std::size_t>& open,
+        std::string_view borrowed)
+        : arena(arena)
+        , pending(pending)
+        , open(open)
+        , borrowed(borrowed)
+    {}
+
+    void StartObject() { Open(); }
+    void StartArray() { Open(); }
+
+    void FinishObject()
+    {
+        auto first = open.back();
+        auto count = pending.size() - first;
+        Member* members = nullptr;
+        if (count != 0)
+        {
+            auto bytes = count * sizeof(Member)
+                + (count > Value::indexed_size ? count * sizeof(std::uint32_t) : 0);
+            members = static_cast<Member*>(arena.Allocate(bytes, alignof(Member)));
+            std::uninitialized_copy(pending.begin() + first, pending.end(), members);
+            if (count > Value::indexed_size)
+            {
+                auto index = reinterpret_cast<std::uint32_t*>(members + count);
+                for (std::uint32_t i = 0; i < count; ++i)
+                    index[i] = i;
+                // Stable, so that lookups find the first of duplicate keys
+                std::stable_sort(index, index + count, [members](auto a, auto b) {
+                    return members[a].key < members[b].key;
+                });
+            }
+        }
+        Value value;
+        value.type = ValueType::Object;
+        value.size = Size(count);
+        value.members = members;
+        Close(first, value);
+    }
+
+    void FinishArray()
+    {
+        auto first = open.back();
+        auto count = pending.size() - first;
+        Value* elements = nullptr;
+        if (count != 0)
+        {
+            elements = static_cast<Value*>(
+                arena.Allocate(count * sizeof(Value), alignof(Value)));
+            for (std::size_t i = 0; i < count; ++i)
+                ::new (elements + i) Value(pending[first + i].value);
+        }
+        Value value;
+        value.type = ValueType::Array;
+        value.size = Size(count);
+        value.elements = elements;
+        Close(first, value);
+    }
+
+    void Key(std::string_view str) { key = Store(str); }
+
+    void String(std::string_view str)
+    {
+        str = Store(str);
+        Value value;
+        value.type = ValueType::String;
+        value.size = Size(str.size());
+        value.string = str.data();
+        Add(value);
+    }
+    void Bool(bool val)
+    {
+        Value value;
+        value.type = ValueType::Bool;
+        value.boolean = val;
+        Add(value);
+    }
+    void Int(std::intmax_t val)
+    {
+        Value value;
+        value.type = ValueType::Int;
+        value.integer = val;
+        Add(value);
+    }
+    void Float(double val)
+    {
+        Value value;
+        value.type = ValueType::Float;
+        value.number = val;
+        Add(value);
+    }
+    void Null() { Add(Value()); }
+
+    Value root;
+
+private:
+    void Open()
+    {
+        pending.push_back({key, Value()});
+        open.push_back(pending.size());
+    }
+
+    /// Drops the values of the container starting at `first` from the stack
+    /// and replaces its placeholder with `value`
+    void Close(std::size_t first, const Value& value)
+    {
+        pending.resize(first);
+        pending.back().value = value;
+        open.pop_back();
+        if (open.empty())
+        {
+            root = value;
+            pending.pop_back();
+        }
+    }
+
+    static std::uint32_t Size(std::size_t size)
+    {
+        if (size > std::numeric_limits<std::uint32_t>::max())
+            throw std::length_error("JSON value too large for Document");
+        return static_cast<std::uint32_t>(size);
+    }
 
-/// number
-///     integer fraction exponent
-template<typename THandler, typename IStream>
-void ParseNumber(THandler& handler, IStream& istream);
+    std::string_view Store(std::string_view str)
+    {
+        if (std::greater_equal<>()(str.data(), borrowed.data())
+            && std::less<>()(str.data(), borrowed.data() + borrowed.size()))
+            return str;
+        if (str.empty())
+            return {};
+        auto copy = static_cast<char*>(arena.Allocate(str.size(), 1));
+        std::memcpy(copy, str.data(), str.size());
+        return {copy, str.size()};
+    }
 
-/// bool-literal
-///     "true"
-///     "false"
-template<typename THandler, typename IStream>
-void ParseBoolLiteral(THandler& handler, IStream& istream);
+    void Add(const Value& value)
+    {
+        if (open.empty())
+            root = value;
+        else
+            pending.push_back({key, value});
+    }
 
-/// null
-template<typename THandler, typename IStream>
-void ParseNull(THandler& handler, IStream& istream);
+    Arena& arena;
+    std::vector<Member>& pending;
+    std::vector<std::size_t>& open;
+    std::string_view borrowed;
+    std::string_view key;
+};
+} // namespace detail
 
-template<typename THandler>
-void AddToString(std::string& str, int ch, THandler& handler)
+/// Random-access tree of a JSON document, built from the events of Parse.
+///
+/// All strings, arrays and objects are allocated from a monotonic arena owned
+/// by the Document, so building it costs no allocation per value, and
+/// destroying it frees a few large blocks at once. Elements and members are
+/// stored contiguously, in input order. Parsing again reuses the arena, and
+/// invalidates all values of the previous document.
+class Document
 {
-    if (ch == -1)
-        handler.Error("Unexpected EOF"s);
+public:
+    /// Parses `json`, copying all strings into the document
+    ParseResult Parse(std::string_view json, const ParseOptions& options = {})
+    {
+        return Build(json, {}, options);
+    }
 
-    str += static_cast<char>(ch);
-}
+    /// Parses `json` like Parse, but strings without escape sequences point
+    /// into `json` instead of being copied. `json` must outlive the document.
+    ParseResult ParseBorrowed(std::string_view json, const ParseOptions& options = {})
+    {
+        return Build(json, json, options);
+    }
 
-template<typename THandler, typename IStream>
-void SkipWhitespace([[maybe_unused]] THandler& handler, IStream& istream)
-{
-    auto ch = istream.peek();
-    while (ch == ' ' || ch == '\n' || ch == '\r' || ch == '\t')
+    template<typename IStream = std::istream>
+        requires(!std::convertible_to<IStream&, std::string_view>)
+    ParseResult Parse(IStream& istream, const ParseOptions& options = {})
     {
-        istream.get();
-        ch = istream.peek();
+        arena.Reset(0);
+        detail::DocumentBuilder builder{arena, pending, open, {}};
+        return Finish(builder, saxy_json::Parse(builder, istream, options));
     }
-}
 
-template<typename THandler, typename IStream>
-void Expect(int c, THandler& handler, IStream& istream)
-{
-    int ch = istream.get();
-    if (ch != c)
-        handler.Error("Unexpected char '"s + static_cast<char>(ch) + "'"s);
-}
+    /// The top-level value, which is null if parsing failed
+    const Value& Root() const { return root; }
 
-template<typename THandler, typename IStream>
-std::string GetEscapedString(THandler& handler, IStream& istream)
-{
-    Expect('"', handler, istream);
-    std::string str;
-    auto ch = istream.get();
-    while (ch != '"')
+private:
+    ParseResult Build(
+        std::string_view json, std::string_view borrowed, const ParseOptions& options)
     {
-        if (ch == '\\')
-        {
-            ch = istream.get();
-            switch (ch)
-            {
-            case '"': str += '"'; break;
-            case '\\': str += '\\'; break;
-            case '/': str += '/'; break;
-            case 'b': str += '\b'; break;
-            case 'f': str += '\f'; break;
-            case 'n': str += '\n'; break;
-            case 'r': str += '\r'; break;
-            case 't': str += '\t'; break;
-            case 'u':
-            {
-                std::array<char, 2> first;
-                std::array<char, 2> second;
-
-                if (!isxdigit(istream.peek()))
-                    handler.Error("Invalid hex character '"s + static_cast<char>(istream.peek()) + "'"s);
-                first[0] = static_cast<char>(istream.peek());
-                istream.get();
+        // Nodes take more room than the text they are parsed from, unless
+        // strings are borrowed
+        arena.Reset(borrowed.empty() ? json.size() * 2 : json.size());
+        detail::DocumentBuilder builder{arena, pending, open, borrowed};
+        return Finish(builder, saxy_json::Parse(builder, json, options));
+    }
 
-                if (!isxdigit(istream.peek()))
-                    handler.Error("Invalid hex character '"s + static_cast<char>(istream.peek()) + "'"s);
-                first[1] = static_cast<char>(istream.peek());
-                istream.get();
+    ParseResult Finish(const detail::DocumentBuilder& builder, const ParseResult& result)
+    {
+        root = result ? builder.root : Value();
+        pending.clear();
+        open.clear();
+        return result;
+    }
 
-                if (!isxdigit(istream.peek()))
-                    handler.Error("Invalid hex character '"s + static_cast<char>(istream.peek()) + "'"s);
-                second[0] = static_cast<char>(istream.peek());
-                istream.get();
+    detail::Arena arena;
+    Value root;
+    // Stacks of the builder, kept to reuse their memory
+    std::vector<Member> pending;
+    std::vector<std::size_t> open;
+};
 
-                if (!isxdigit(istream.peek()))
-                    handler.Error("Invalid hex character '"s + static_cast<char>(istream.peek()) + "'"s);
-                second[1] = static_cast<char>(istream.peek());
+// SAXY_JSON_FOR_EACH(macro, T, a, b, c) expands to
+// `macro(T, a), macro(T, b), macro(T, c)`, for up to 256 arguments
+#define SAXY_JSON_PARENS ()
+#define SAXY_JSON_EXPAND(...) \
+    SAXY_JSON_EXPAND4(SAXY_JSON_EXPAND4(SAXY_JSON_EXPAND4(SAXY_JSON_EXPAND4(__VA_ARGS__))))
+#define SAXY_JSON_EXPAND4(...) \
+    SAXY_JSON_EXPAND3(SAXY_JSON_EXPAND3(SAXY_JSON_EXPAND3(SAXY_JSON_EXPAND3(__VA_ARGS__))))
+#define SAXY_JSON_EXPAND3(...) \
+    SAXY_JSON_EXPAND2(SAXY_JSON_EXPAND2(SAXY_JSON_EXPAND2(SAXY_JSON_EXPAND2(__VA_ARGS__))))
+#define SAXY_JSON_EXPAND2(...) \
+    SAXY_JSON_EXPAND1(SAXY_JSON_EXPAND1(SAXY_JSON_EXPAND1(SAXY_JSON_EXPAND1(__VA_ARGS__))))
+#define SAXY_JSON_EXPAND1(...) __VA_ARGS__
+#define SAXY_JSON_FOR_EACH(macro, T, ...) \
+    __VA_OPT__(SAXY_JSON_EXPAND(SAXY_JSON_FOR_EACH_HELPER(macro, T, __VA_ARGS__)))
+#define SAXY_JSON_FOR_EACH_HELPER(macro, T, first, ...) \
+    macro(T, first) __VA_OPT__(, SAXY_JSON_FOR_EACH_AGAIN SAXY_JSON_PARENS(macro, T, __VA_ARGS__))
+#define SAXY_JSON_FOR_EACH_AGAIN() SAXY_JSON_FOR_EACH_HELPER
 
-                uint8_t res;
-                std::from_chars(first.data(), first.data() + first.size(), res, 16);
-                if (res != 0)
-                    str += static_cast<char>(res);
+#define SAXY_JSON_FIELD(T, name) ::saxy_json::Field<T, decltype(T::name)>{#name, &T::name}
 
-                std::from_chars(second.data(), second.data() + second.size(), res, 16);
-                str += static_cast<char>(res);
-            }
-            break;
-            default:
-                handler.Error("Invalid escape character '"s + static_cast<char>(ch) + "'"s);
-            }
-        }
-        else
-        {
-            AddToString(str, ch, handler);
-        }
-        ch = istream.get();
+/// Binds the members of struct `T` to the members of a JSON object with the
+/// same names, for ParseInto and Write. Use it in the namespace of `T`:
+///
+///     struct Point { int x; int y; };
+///     SAXY_JSON_FIELDS(Point, x, y)
+#define SAXY_JSON_FIELDS(T, ...)                                         \
+    [[maybe_unused]] constexpr auto SaxyJsonFields(const T*)             \
+    {                                                                    \
+        return std::make_tuple(SAXY_JSON_FOR_EACH(SAXY_JSON_FIELD, T, __VA_ARGS__)); \
     }
-    return str;
-}
 
-template<typename THandler, typename IStream>
-void ParseJson(THandler& handler, IStream& istream)
+/// A struct member bound to a JSON object member by SAXY_JSON_FIELDS
+template<typename T, typename M>
+struct Field
 {
-    ParseElement(handler, istream);
-}
+    std::string_view name;
+    M T::*member;
+};
 
-template<typename THandler, typename IStream>
-void ParseValue(THandler& handler, IStream& istream)
+namespace detail
 {
-    switch (istream.peek())
-    {
-        case '{': ParseObject(handler, istream); break;
-        case '[': ParseArray(handler, istream); break;
-        case '"': ParseString(handler, istream); break;
-        case '-': [[fallthrough]];
-        case '0': [[fallthrough]];
-        case '1': [[fallthrough]];
-        case '2': [[fallthrough]];
-        case '3': [[fallthrough]];
-        case '4': [[fallthrough]];
-        case '5': [[fallthrough]];
-        case '6': [[fallthrough]];
-        case '7': [[fallthrough]];
-        case '8': [[fallthrough]];
-        case '9': ParseNumber(handler, istream); break;
-        case 't': [[fallthrough]];
-        case 'f': ParseBoolLiteral(handler, istream); break;
-        case 'n': ParseNull(handler, istream); break;
-        default: handler.Error("Unexpected character '"s + static_cast<char>(istream.peek()) + "' in ParseValue"s);
-    }
-}
+template<typename T>
+concept HasFields = requires(const T* object) { SaxyJsonFields(object); };
 
-template<typename THandler, typename IStream>
-void ParseObject(THandler& handler, IStream& istream)
-{
-    handler.StartObject();
-    istream.get();
+/// Character types are not numbers, even though they are integral
+template<typename T>
+concept Character = std::same_as<T, char> || std::same_as<T, wchar_t>
+    || std::same_as<T, char8_t> || std::same_as<T, char16_t> || std::same_as<T, char32_t>;
 
-    ParseMembers(handler, istream);
+template<typename T>
+constexpr bool is_bindable = (std::integral<T> && !Character<T>) || std::floating_point<T>
+    || std::same_as<T, std::string> || HasFields<T>;
+template<typename T, typename Allocator>
+constexpr bool is_bindable<std::vector<T, Allocator>> =
+    !std::same_as<T, bool> && is_bindable<T>;
+template<typename T>
+constexpr bool is_bindable<std::optional<T>> = is_bindable<T>;
+} // namespace detail
 
-    Expect('}', handler, istream);
-    handler.FinishObject();
+/// Types ParseInto can parse into and Write can write: booleans, numbers
+/// other than character types, `std::string`, structs declared with
+/// SAXY_JSON_FIELDS, and `std::vector` and `std::optional` of these
+template<typename T>
+concept Bindable = detail::is_bindable<T>;
+
+namespace detail
+{
+/// Length, first and last character of a key, compared before the key itself
+constexpr std::uint32_t KeySignature(std::string_view key)
+{
+    if (key.empty())
+        return 0;
+    return static_cast<std::uint32_t>(key.size() & 0xffff)
+        | static_cast<std::uint32_t>(static_cast<unsigned char>(key.front())) << 16
+        | static_cast<std::uint32_t>(static_cast<unsigned char>(key.back())) << 24;
 }
 
-template<typename THandler, typename IStream>
-void ParseMembers(THandler& handler, IStream& istream)
+inline constexpr std::size_t no_field = std::numeric_limits<std::size_t>::max();
+
+/// The members of a struct declared with SAXY_JSON_FIELDS
+template<typename T>
+struct FieldTable
 {
-    ParseMember(handler, istream);
-    while (istream.peek() == ',')
+    static constexpr auto fields = SaxyJsonFields(static_cast<const T*>(nullptr));
+    static constexpr std::size_t count = std::tuple_size_v<decltype(fields)>;
+
+    static constexpr auto signatures = []<std::size_t... I>(std::index_sequence<I...>) {
+        return std::array<std::uint32_t, count>{KeySignature(std::get<I>(fields).name)...};
+    }(std::make_index_sequence<count>());
+
+    /// Index of the field named `key`, or no_field if there is none
+    static std::size_t Find(std::string_view key)
     {
-        istream.get();
-        ParseMember(handler, istream);
+        auto signature = KeySignature(key);
+        std::size_t index = no_field;
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            // Unrolled over the fields, comparing keys only if their
+            // signatures match
+            (void)((signatures[I] == signature && std::get<I>(fields).name == key
+                    && (index = I, true))
+                   || ...);
+        }(std::make_index_sequence<count>());
+        return index;
     }
-}
 
-template<typename THandler, typename IStream>
-void ParseMember(THandler& handler, IStream& istream)
-{
-    SkipWhitespace(handler, istream);
+    /// Calls `f` with the member of `object` at `index`, which is less than
+    /// `count`, and returns its result
+    template<typename F>
+    static bool Visit(T& object, std::size_t index, F&& f)
+    {
+        bool result = false;
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            (void)((index == I && (result = f(object.*std::get<I>(fields).member), true))
+                   || ...);
+        }(std::make_index_sequence<count>());
+        return result;
+    }
+};
 
-    if (istream.peek() == '}')
-        return;
+template<typename T>
+constexpr bool is_optional = false;
+template<typename T>
+constexpr bool is_optional<std::optional<T>> = true;
 
-    auto key = GetEscapedString(handler, istream);
-    handler.Key(std::move(key));
-    SkipWhitespace(handler, istream);
-    Expect(':', handler, istream);
-    ParseElement(handler, istream);
-}
+template<typename T>
+constexpr bool is_vector = false;
+template<typename T, typename Allocator>
+constexpr bool is_vector<std::vector<T, Allocator>> = true;
 
-template<typename THandler, typename IStream>
-void ParseArray(THandler& handler, IStream& istream)
+/// Stores scalar values into an object of a bound type, or returns false if
+/// the value does not fit the type
+template<typename T>
+struct Binding
 {
-    istream.get();
-    handler.StartArray();
-    ParseElements(handler, istream);
-    Expect(']', handler, istream);
-    handler.FinishArray();
-}
+    static bool Int(T& value, std::intmax_t val)
+    {
+        if constexpr (std::integral<T> && !std::same_as<T, bool>)
+        {
+            if (!std::in_range<T>(val))
+                return false;
+            value = static_cast<T>(val);
+            return true;
+        }
+        else if constexpr (std::floating_point<T>)
+        {
+            value = static_cast<T>(val);
+            return true;
+        }
+        else if constexpr (is_optional<T>)
+        {
+            return Binding<typename T::value_type>::Int(value.emplace(), val);
+        }
+        else
+        {
+            return false;
+        }
+    }
 
-template<typename THandler, typename IStream>
-void ParseElements(THandler& handler, IStream& istream)
-{
-    SkipWhitespace(handler, istream);
+    /// Positive integers above the range of std::intmax_t
+    static bool Uint(T& value, std::uint64_t val)
+    {
+        if constexpr (std::integral<T> && !std::same_as<T, bool>)
+        {
+            if (!std::in_range<T>(val))
+                return false;
+            value = static_cast<T>(val);
+            return true;
+        }
+        else if constexpr (std::floating_point<T>)
+        {
+            value = static_cast<T>(val);
+            return true;
+        }
+        else if constexpr (is_optional<T>)
+        {
+            return Binding<typename T::value_type>::Uint(value.emplace(), val);
+        }
+        else
+        {
+            return false;
+        }
+    }
 
-    if (istream.peek() == ']')
-        return;
+    static bool Float(T& value, double val)
+    {
+        if constexpr (std::floating_point<T>)
+        {
+            value = static_cast<T>(val);
+            return true;
+        }
+        else if constexpr (is_optional<T>)
+        {
+            return Binding<typename T::value_type>::Float(value.emplace(), val);
+        }
+        else
+        {
+            return false;
+        }
+    }
 
-    ParseElement(handler, istream);
+    static bool Bool(T& value, bool val)
+    {
+        if constexpr (std::same_as<T, bool>)
+        {
+            value = val;
+            return true;
+        }
+        else if constexpr (is_optional<T>)
+        {
+            return Binding<typename T::value_type>::Bool(value.emplace(), val);
+        }
+        else
+        {
+            return false;
+        }
+    }
 
-    while (istream.peek() == ',')
+    static bool String(T& value, std::string_view val)
     {
-        istream.get();
-        ParseElement(handler, istream);
+        if constexpr (std::same_as<T, std::string>)
+        {
+            value.assign(val.data(), val.size());
+            return true;
+        }
+        else if constexpr (is_optional<T>)
+        {
+            return Binding<typename T::value_type>::String(value.emplace(), val);
+        }
+        else
+        {
+            return false;
+        }
     }
-}
 
-/// element
-///     ws value ws
-template<typename THandler, typename IStream>
-void ParseElement(THandler& handler, IStream& istream)
-{
-    SkipWhitespace(handler, istream);
-    ParseValue(handler, istream);
-    SkipWhitespace(handler, istream);
-}
+    static bool Null(T& value)
+    {
+        if constexpr (is_optional<T>)
+        {
+            value.reset();
+            return true;
+        }
+        else
+        {
+            return false;
+        }
+    }
+};
 
-/// string
-///     '"' characters '"'
-template<typename THandler, typename IStream>
-void ParseString(THandler& handler, IStream& istream)
+/// Handler storing the events straight into an object of the bound type `T`.
+///
+/// The open objects and arrays are a path of field indices from the bound
+/// object. Every value is stored by following the path with the types of all
+/// members known at compile time, so the fields are selected by inlined
+/// comparisons instead of indirect calls.
+template<typename T>
+class Binder
 {
-    auto str = GetEscapedString(handler, istream);
-    handler.String(std::move(str));
-}
+public:
+    explicit Binder(T& value)
+        : value(value)
+    {}
 
-/// number
-///     integer fraction exponent
-template<typename THandler, typename IStream>
-void ParseNumber(THandler& handler, IStream& istream)
-{
-    std::string number;
-    if (istream.peek() == '-')
-        AddToString(number, istream.get(), handler);
+    Control StartObject()
+    {
+        return Store([this](auto& target) { return Open<true>(target); });
+    }
+    Control FinishObject()
+    {
+        path.pop_back();
+        return Control::Continue;
+    }
+    Control StartArray()
+    {
+        return Store([this](auto& target) { return Open<false>(target); });
+    }
+    Control FinishArray()
+    {
+        path.pop_back();
+        return Control::Continue;
+    }
+    /// Unknown keys skip their value
+    Control Key(std::string_view key)
+    {
+        Descend(value, 0, path.size() - 1, [&](auto& object) {
+            path.back() = FindField<std::remove_cvref_t<decltype(object)>>(key);
+            return true;
+        });
+        return path.back() != no_field ? Control::Continue : Control::Skip;
+    }
+    Control String(std::string_view val)
+    {
+        return Store([&](auto& target) { return BindingOf<decltype(target)>::String(target, val); });
+    }
+    Control Bool(bool val)
+    {
+        return Store([&](auto& target) { return BindingOf<decltype(target)>::Bool(target, val); });
+    }
+    Control Int(std::intmax_t val)
+    {
+        return Store([&](auto& target) { return BindingOf<decltype(target)>::Int(target, val); });
+    }
+    Control Uint(std::uint64_t val)
+    {
+        return Store([&](auto& target) { return BindingOf<decltype(target)>::Uint(target, val); });
+    }
+    Control Float(double val)
+    {
+        return Store([&](auto& target) { return BindingOf<decltype(target)>::Float(target, val); });
+    }
+    Control Null()
+    {
+        return Store([&](auto& target) { return BindingOf<decltype(target)>::Null(target); });
+    }
 
-    while (std::isdigit(istream.peek()))
-        AddToString(number, istream.get(), handler);
+    /// Set when a value did not match the bound type
+    bool mismatch = false;
 
-    if (istream.peek() != '.' && istream.peek() != 'e' && istream.peek() != 'E')
+private:
+    template<typename U>
+    using BindingOf = Binding<std::remove_cvref_t<U>>;
+
+    /// Index of the field named `key` of the struct `U`, which may be in an
+    /// optional
+    template<typename U>
+    static std::size_t FindField(std::string_view key)
     {
-        // Integer
-        std::intmax_t integer;
-        const auto& [ptr, ec] = std::from_chars(number.data(), number.data() + number.size(), integer);
-        if (ec == std::errc{})
-            handler.Int(integer);
+        if constexpr (is_optional<U>)
+            return FindField<typename U::value_type>(key);
+        else if constexpr (HasFields<U>)
+            return FieldTable<U>::Find(key);
         else
-            handler.Error("Could not convert '"s + number + "' to integer"s);
+            return no_field;
     }
-    else
+
+    /// Calls `store` with the value of the next event: the bound object, the
+    /// member of the last key or a new element of the innermost array
+    template<typename F>
+    Control Store(F&& store)
     {
-        istream.get();
-        auto ch = istream.peek();
-        while (std::isdigit(ch) || ch == 'e' || ch == 'E' || ch == '+' || ch == '-')
+        if (Descend(value, 0, path.size(), store))
+            return Control::Continue;
+        mismatch = true;
+        return Control::Stop;
+    }
+
+    /// Follows the path from `current` at `level` down to `depth` and calls
+    /// `f` there. Optionals on the way have been emplaced when they were
+    /// opened.
+    template<typename U, typename F>
+    bool Descend(U& current, std::size_t level, std::size_t depth, F&& f)
+    {
+        if (level == depth)
+            return f(current);
+        if constexpr (is_optional<U>)
         {
-            AddToString(number, istream.get(), handler);
-            ch = istream.peek();
+            return Descend(*current, level, depth, f);
+        }
+        else if constexpr (HasFields<U>)
+        {
+            return FieldTable<U>::Visit(current, path[level], [&](auto& member) {
+                return Descend(member, level + 1, depth, f);
+            });
+        }
+        else if constexpr (is_vector<U>)
+        {
+            auto& element = level + 1 == path.size() ? current.emplace_back() : current.back();
+            return Descend(element, level + 1, depth, f);
         }
-        double floating_point;
-        const auto& [ptr, ec] = std::from_chars(number.data(), number.data() + number.size(), floating_point);
-        if (ec == std::errc{})
-            handler.Float(floating_point);
         else
-            handler.Error("Could not convert '"s + number + "' to float"s);
+        {
+            return false;
+        }
     }
-}
 
-template<typename THandler, typename IStream>
-void ParseBoolLiteral(THandler& handler, IStream& istream)
-{
-    if (istream.peek() == 't')
+    /// Opens `target` as an object or an array, if it is a struct or vector
+    template<bool is_object, typename U>
+    bool Open(U& target)
     {
-        Expect('t', handler, istream);
-        Expect('r', handler, istream);
-        Expect('u', handler, istream);
-        Expect('e', handler, istream);
-        handler.Bool(true);
-    }
-    else if (istream.peek() == 'f')
-    {
-        Expect('f', handler, istream);
-        Expect('a', handler, istream);
-        Expect('l', handler, istream);
-        Expect('s', handler, istream);
-        Expect('e', handler, istream);
-        handler.Bool(false);
+        if constexpr (is_optional<U>)
+        {
+            return Open<is_object>(target.emplace());
+        }
+        else if constexpr (is_object ? HasFields<U> : is_vector<U>)
+        {
+            if constexpr (!is_object)
+                target.clear();
+            path.push_back(0);
+            return true;
+        }
+        else
+        {
+            return false;
+        }
     }
+
+    T& value;
+    /// One entry per open object or array: the index of the field of the
+    /// last key, or no_field, and unused for arrays
+    std::vector<std::size_t> path;
+};
+
+template<typename T, typename IStream>
+ParseResult ParseBound(Binder<T>& binder, IStream& reader, const ParseOptions& options)
+{
+    ParseJson(binder, reader, options);
+    if (binder.mismatch)
+        reader.Fail(ErrorCode::TypeMismatch, EOF, false);
+    return reader.Result();
 }
+} // namespace detail
 
-template<typename THandler, typename IStream>
-void ParseNull(THandler& handler, IStream& istream)
+/// Parses `json` straight into `value`.
+///
+/// Members of structs are looked up by the length, first and last character
+/// of the key before comparing it, in an unrolled loop over the fields. JSON
+/// members without a field are skipped, fields without a JSON member keep
+/// their value. Vectors are cleared before their elements are appended.
+/// Values that do not fit the type end parsing with ErrorCode::TypeMismatch,
+/// located after the offending value.
+template<Bindable T>
+ParseResult ParseInto(T& value, std::string_view json, const ParseOptions& options = {})
 {
-    Expect('n', handler, istream);
-    Expect('u', handler, istream);
-    Expect('l', handler, istream);
-    Expect('l', handler, istream);
-    handler.Null();
+    detail::Binder<T> binder{value};
+    detail::BufferReader reader{json.data(), json.data() + json.size()};
+    return detail::ParseBound(binder, reader, options);
 }
 
+template<Bindable T, typename IStream = std::istream>
+    requires(!std::convertible_to<IStream&, std::string_view>)
+ParseResult ParseInto(T& value, IStream& istream, const ParseOptions& options = {})
+{
+    detail::Binder<T> binder{value};
+    detail::StreamReader<IStream> reader{istream};
+    return detail::ParseBound(binder, reader, options);
 }
 
-template<typename THandler, typename IStream = std::istream>
-void Parse(THandler& handler, IStream& istream)
+/// Writes `value` with a Writer or PrettyWriter, as ParseInto reads it. Empty
+/// optionals are written as null.
+template<typename TWriter, Bindable T>
+void Write(TWriter& writer, const T& value)
 {
-    detail::ParseJson(handler, istream);
+    if constexpr (std::same_as<T, bool>)
+    {
+        writer.Bool(value);
+    }
+    else if constexpr (std::integral<T>)
+    {
+        writer.Int(value);
+    }
+    else if constexpr (std::floating_point<T>)
+    {
+        writer.Float(value);
+    }
+    else if constexpr (std::same_as<T, std::string>)
+    {
+        writer.String(value);
+    }
+    else if constexpr (detail::HasFields<T>)
+    {
+        writer.StartObject();
+        std::apply(
+            [&](const auto&... fields) {
+                ((writer.Key(fields.name), Write(writer, value.*fields.member)), ...);
+            },
+            detail::FieldTable<T>::fields);
+        writer.FinishObject();
+    }
+    else if constexpr (detail::is_optional<T>)
+    {
+        if (value)
+            Write(writer, *value);
+        else
+            writer.Null();
+    }
+    else
+    {
+        writer.StartArray();
+        for (const auto& element : value)
+            Write(writer, element);
+        writer.FinishArray();
+    }
 }
 
 } // namespace saxy_json
@@ -1,7 +1,5 @@
 #include "../include/saxy-json.hpp"
-#include <fstream>
 #include <iostream>
-#include <stdexcept>
 
 class TestHandler
 {
@@ -16,10 +14,6 @@ public:
     void Float(double) {}
     void Bool(bool) {}
     void Null() {}
-    void Error(std::string&& msg)
-    {
-        throw std::runtime_error(std::move(msg));
-    }
 };
 
 int main(int argc, const char* argv[])
@@ -29,17 +23,10 @@ int main(int argc, const char* argv[])
         std::cerr << "Usage: " << argv[0] << " INFILE" << std::endl;
     }
 
-    auto file = std::ifstream(argv[1], std::ios::in);
     auto handler = TestHandler();
     std::cout << argv[1] << ';';
-    try
-    {
-        saxy_json::Parse(handler, file);
+    if (auto result = saxy_json::ParseFile(handler, argv[1]))
         std::cout << "Accepted" << std::endl;
-    }
-    catch (const std::runtime_error& err)
-    {
-        std::cout << "Failed with " << err.what() << std::endl;
-    }
+    else
+        std::cout << "Failed with " << result.Message() << std::endl;
 }
-
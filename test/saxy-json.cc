@@ -1,8 +1,16 @@
 #include <catch2/catch.hpp>
 #include "../include/saxy-json.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <optional>
 #include <stdexcept>
 #include <string_view>
+#include <thread>
 
 using namespace saxy_json;
 
@@ -54,10 +62,42 @@ TEST_CASE("Writer", "[write]")
     Writer writer{std::cout};
 
     build_object(writer);
+    writer.Flush();
 
     std::cout << std::endl;
 }
 
+TEST_CASE("Buffered Writer", "[write]")
+{
+    std::string expected;
+    {
+        Writer writer{expected};
+        build_object(writer);
+    }
+
+    std::ostringstream out;
+    {
+        Writer writer{out, 16};
+        build_object(writer);
+        REQUIRE(out.str().size() > 0);
+        REQUIRE(out.str().size() < expected.size());
+        writer.Flush();
+        REQUIRE(out.str() == expected);
+        writer.RawString(" ");
+    }
+    REQUIRE(out.str() == expected + " ");
+
+    std::ostringstream pretty_out;
+    std::string pretty_expected;
+    {
+        PrettyWriter writer{pretty_out, 2, 1};
+        PrettyWriter string_writer{pretty_expected, 2};
+        build_object(writer);
+        build_object(string_writer);
+    }
+    REQUIRE(pretty_out.str() == pretty_expected);
+}
+
 TEST_CASE("PrettyWriter", "[pretty_write]")
 {
     std::string res;
@@ -158,6 +198,11 @@ TEST_CASE("JSON parser")
 
             REQUIRE(handler.events.size() > 0);
             REQUIRE(handler.events[0] != "Error");
+
+            TestHandler buffer_handler;
+            Parse(buffer_handler, std::string_view(test));
+
+            REQUIRE(buffer_handler.events == handler.events);
         }
     }
 
@@ -177,6 +222,1492 @@ TEST_CASE("JSON parser")
             TestHandler handler;
             std::istringstream input(test);
             REQUIRE_THROWS(Parse(handler, input));
+
+            TestHandler buffer_handler;
+            REQUIRE_THROWS(Parse(buffer_handler, std::string_view(test)));
+        }
+    }
+}
+
+TEST_CASE("Buffer parser")
+{
+    std::string json = R"({"a": [1, -2, 3.5, 1e2, "x\ty"], "b": null})";
+
+    TestHandler handler;
+    Parse(handler, json.data(), json.data() + json.size());
+
+    std::vector<std::string> expected = {
+        "StartObject", "Key:a",          "StartArray",    "Int:1",
+        "Int:-2",      "Float:3.500000", "Float:100.000000", "String:x\ty",
+        "FinishArray", "Key:b",          "Null",          "FinishObject",
+    };
+    REQUIRE(handler.events == expected);
+}
+
+class ViewHandler : public TestHandler
+{
+public:
+    void Key(std::string_view key)
+    {
+        events.push_back("Key:" + std::string(key));
+        views.push_back(key);
+    }
+    void String(std::string_view str)
+    {
+        events.push_back("String:" + std::string(str));
+        views.push_back(str);
+    }
+
+    std::vector<std::string_view> views;
+};
+
+TEST_CASE("Zero-copy string views")
+{
+    std::string json = R"({"plain": "value", "esc\"aped": "line\nbreak"})";
+
+    ViewHandler handler;
+    Parse(handler, std::string_view(json));
+
+    std::vector<std::string> expected = {
+        "StartObject",        "Key:plain",         "String:value",
+        "Key:esc\"aped",      "String:line\nbreak", "FinishObject",
+    };
+    REQUIRE(handler.events == expected);
+
+    auto in_input = [&json](std::string_view view) {
+        return view.data() >= json.data()
+            && view.data() + view.size() <= json.data() + json.size();
+    };
+    REQUIRE(in_input(handler.views[0]));
+    REQUIRE(in_input(handler.views[1]));
+    REQUIRE_FALSE(in_input(handler.views[2]));
+    REQUIRE_FALSE(in_input(handler.views[3]));
+}
+
+TEST_CASE("Long strings and whitespace runs")
+{
+    // Place escapes, quotes and whitespace at every offset of the vector
+    // kernels' block sizes
+    for (std::size_t len = 0; len < 70; ++len)
+    {
+        std::string padding(len, ' ');
+        std::string plain(len, 'a');
+        std::string json = "[" + padding + "\"" + plain + "\\n" + plain + "\""
+            + padding + "," + padding + "\"" + plain + "\"" + padding + "]";
+
+        TestHandler handler;
+        Parse(handler, std::string_view(json));
+
+        std::vector<std::string> expected = {
+            "StartArray",
+            "String:" + plain + "\n" + plain,
+            "String:" + plain,
+            "FinishArray",
+        };
+        REQUIRE(handler.events == expected);
+
+        std::string invalid = "[\"" + plain + "\t\"]";
+        TestHandler invalid_handler;
+        REQUIRE_THROWS(Parse(invalid_handler, std::string_view(invalid)));
+    }
+}
+
+class NumberHandler : public TestHandler
+{
+public:
+    void Int(std::intmax_t i) { ints.push_back(i); }
+    void Float(double d) { floats.push_back(d); }
+
+    std::vector<std::intmax_t> ints;
+    std::vector<double> floats;
+};
+
+class UintHandler : public NumberHandler
+{
+public:
+    void Uint(std::uint64_t u) { uints.push_back(u); }
+
+    std::vector<std::uint64_t> uints;
+};
+
+/// Forwards all events to a writer, with numbers passed through unconverted
+template<typename TWriter>
+class PassThroughHandler
+{
+public:
+    explicit PassThroughHandler(TWriter& writer)
+        : writer(writer)
+    {}
+
+    void StartObject() { writer.StartObject(); }
+    void FinishObject() { writer.FinishObject(); }
+    void StartArray() { writer.StartArray(); }
+    void FinishArray() { writer.FinishArray(); }
+    void Key(std::string_view key) { writer.Key(key); }
+    void String(std::string_view str) { writer.String(str); }
+    void RawNumber(std::string_view number) { writer.RawNumber(number); }
+    void Bool(bool b) { writer.Bool(b); }
+    void Null() { writer.Null(); }
+
+private:
+    TWriter& writer;
+};
+
+TEST_CASE("Numbers")
+{
+    SECTION("Integers")
+    {
+        std::vector<std::pair<std::string, std::intmax_t>> tests = {
+            {"0", 0},
+            {"-0", 0},
+            {"42", 42},
+            {"-17", -17},
+            {"9223372036854775807", std::numeric_limits<std::intmax_t>::max()},
+            {"-9223372036854775808", std::numeric_limits<std::intmax_t>::min()},
+        };
+
+        for (const auto& [json, value] : tests)
+        {
+            NumberHandler handler;
+            Parse(handler, std::string_view(json));
+            REQUIRE(handler.ints == std::vector<std::intmax_t>{value});
+
+            NumberHandler stream_handler;
+            std::istringstream input(json);
+            Parse(stream_handler, input);
+            REQUIRE(stream_handler.ints == std::vector<std::intmax_t>{value});
+        }
+    }
+
+    SECTION("Floats")
+    {
+        std::vector<std::string> tests = {
+            "3.14",
+            "-0.0",
+            "1e2",
+            "1E-2",
+            "0.000123",
+            "123.456e+7",
+            "9007199254740993.0",
+            "1.7976931348623157e308",
+            "2.2250738585072014e-308",
+            "0.1234567890123456789012345",
+            "12345678901234567890123.5e-3",
+        };
+
+        for (const auto& json : tests)
+        {
+            double expected;
+            std::from_chars(json.data(), json.data() + json.size(), expected);
+
+            NumberHandler handler;
+            Parse(handler, std::string_view(json));
+            REQUIRE(handler.floats == std::vector<double>{expected});
+
+            NumberHandler stream_handler;
+            std::istringstream input(json);
+            Parse(stream_handler, input);
+            REQUIRE(stream_handler.floats == std::vector<double>{expected});
+        }
+    }
+
+    SECTION("Invalid")
+    {
+        std::vector<std::string> tests = {
+            "-",
+            "-01",
+            "01",
+            "2.",
+            "2.e3",
+            "0.e1",
+            "1eE2",
+            "1e",
+            "1e+",
+            "-.5",
+            "9223372036854775808",
+            "-9223372036854775809",
+        };
+
+        for (const auto& json : tests)
+        {
+            NumberHandler handler;
+            REQUIRE_THROWS(Parse(handler, std::string_view(json)));
+
+            NumberHandler stream_handler;
+            std::istringstream input(json);
+            REQUIRE_THROWS(Parse(stream_handler, input));
+        }
+    }
+
+    SECTION("Unsigned")
+    {
+        std::vector<std::pair<std::string, std::uint64_t>> tests = {
+            {"9223372036854775808", std::uint64_t{1} << 63},
+            {"10000000000000000999", 10000000000000000999u},
+            {"18446744073709551615", std::numeric_limits<std::uint64_t>::max()},
+        };
+
+        for (const auto& [json, value] : tests)
+        {
+            UintHandler handler;
+            Parse(handler, std::string_view(json));
+            REQUIRE(handler.uints == std::vector<std::uint64_t>{value});
+
+            UintHandler stream_handler;
+            std::istringstream input(json);
+            Parse(stream_handler, input);
+            REQUIRE(stream_handler.uints == std::vector<std::uint64_t>{value});
+        }
+
+        UintHandler handler;
+        Parse(handler, std::string_view("[42, -1]"));
+        REQUIRE(handler.ints == std::vector<std::intmax_t>{42, -1});
+        REQUIRE(handler.uints.empty());
+        REQUIRE_THROWS(Parse(handler, std::string_view("18446744073709551616")));
+        REQUIRE_THROWS(Parse(handler, std::string_view("-9223372036854775809")));
+    }
+
+    SECTION("Raw")
+    {
+        // Everything but the value itself is kept byte for byte
+        std::vector<std::string> tests = {
+            "0", "-0", "-9223372036854775809", "100000000000000000000000000001",
+            "1.000000000000000005", "1E-999", "1e+400", "-0.0e0",
+        };
+
+        for (const auto& json : tests)
+        {
+            std::string out;
+            {
+                Writer writer{out};
+                PassThroughHandler handler{writer};
+                REQUIRE(Parse(handler, std::string_view(json)));
+            }
+            REQUIRE(out == json);
+
+            std::string stream_out;
+            {
+                Writer writer{stream_out};
+                PassThroughHandler handler{writer};
+                std::istringstream input(json);
+                REQUIRE(Parse(handler, input));
+            }
+            REQUIRE(stream_out == json);
+        }
+
+        std::string out;
+        Writer writer{out};
+        PassThroughHandler handler{writer};
+        REQUIRE(Parse(handler, std::string_view("01")).code == ErrorCode::InvalidNumber);
+        REQUIRE(Parse(handler, std::string_view("1.e5")).code == ErrorCode::InvalidNumber);
+    }
+}
+
+TEST_CASE("Raw number passthrough")
+{
+    for (const auto& entry : std::filesystem::directory_iterator(
+             SAXY_JSON_TEST_FILES "/test_transform"))
+    {
+        auto name = entry.path().filename().string();
+        if (!name.starts_with("number_"))
+            continue;
+
+        INFO(name);
+        std::string json;
+        {
+            std::ifstream file(entry.path(), std::ios::binary);
+            json.assign(std::istreambuf_iterator<char>(file), {});
+        }
+        std::string out, push_out;
+        {
+            Writer writer{out};
+            PassThroughHandler handler{writer};
+            REQUIRE(Parse(handler, json));
+
+            Writer push_writer{push_out};
+            PassThroughHandler push_handler{push_writer};
+            PushParser parser{push_handler};
+            for (auto c : json)
+                REQUIRE(parser.Feed(std::string_view(&c, 1)));
+            REQUIRE(parser.Finish());
+        }
+        json.erase(std::remove(json.begin(), json.end(), '\n'), json.end());
+        REQUIRE(out == json);
+        REQUIRE(push_out == json);
+    }
+}
+
+TEST_CASE("Writer escapes strings", "[write]")
+{
+    std::string out;
+    {
+        Writer writer{out};
+        writer.StartArray();
+        writer.String("plain");
+        writer.String("\"quoted\" back\\slash");
+        writer.String(std::string_view("\b\f\n\r\t\x01\x1f\0", 8));
+        writer.String(std::string(40, 'x') + "\n" + std::string(40, 'y'));
+        writer.FinishArray();
+    }
+
+    REQUIRE(
+        out
+        == R"(["plain","\"quoted\" back\\slash","\b\f\n\r\t\u0001\u001f\u0000",)"
+               R"(")" + std::string(40, 'x') + R"(\n)" + std::string(40, 'y')
+               + R"("])");
+
+    TestHandler handler;
+    Parse(handler, std::string_view(out));
+    REQUIRE(handler.events.size() == 6);
+}
+
+TEST_CASE("Writer numbers", "[write]")
+{
+    SECTION("Integers")
+    {
+        std::string out;
+        {
+            Writer writer{out};
+            writer.StartArray();
+            writer.Int(0);
+            writer.Int(9);
+            writer.Int(10);
+            writer.Int(-99);
+            writer.Int(100);
+            writer.Int(std::int8_t{-128});
+            writer.Int(std::uint8_t{255});
+            writer.Int(std::numeric_limits<std::int64_t>::min());
+            writer.Int(std::numeric_limits<std::int64_t>::max());
+            writer.Int(std::numeric_limits<std::uint64_t>::max());
+            writer.FinishArray();
+        }
+        REQUIRE(
+            out
+            == "[0,9,10,-99,100,-128,255,-9223372036854775808,"
+               "9223372036854775807,18446744073709551615]");
+    }
+
+#if defined(__SIZEOF_INT128__) && !defined(__STRICT_ANSI__)
+    SECTION("128-bit integers")
+    {
+        __extension__ using Int128 = __int128;
+        __extension__ using Uint128 = unsigned __int128;
+        std::string out;
+        {
+            Writer writer{out};
+            writer.StartArray();
+            writer.Int(Int128{1} << 100);
+            writer.Int(std::numeric_limits<Int128>::min());
+            writer.Int(std::numeric_limits<Uint128>::max());
+            writer.IntArray(std::array<Int128, 2>{-1, std::numeric_limits<Int128>::max()});
+            writer.FinishArray();
+        }
+        REQUIRE(
+            out
+            == "[1267650600228229401496703205376,-170141183460469231731687303715884105728,"
+               "340282366920938463463374607431768211455,"
+               "[-1,170141183460469231731687303715884105727]]");
+    }
+#endif
+
+    SECTION("Floats are shortest round-trip")
+    {
+        std::string out;
+        {
+            Writer writer{out};
+            writer.StartArray();
+            writer.Float(0.1);
+            writer.Float(-1.5);
+            writer.Float(1e300);
+            writer.Float(-2.2250738585072014e-308);
+            writer.Float(5e-324);
+            writer.Float(0.1f);
+            writer.FinishArray();
+        }
+        REQUIRE(out == "[0.1,-1.5,1e+300,-2.2250738585072014e-308,5e-324,0.1]");
+
+        std::vector<double> values;
+        for (double value = 1.0 / 3; std::abs(value) < 1e300; value *= -7.3)
+            values.push_back(value);
+        out.clear();
+        {
+            Writer writer{out};
+            writer.FloatArray(values);
+        }
+        Document document;
+        REQUIRE(document.Parse(out));
+        REQUIRE(document.Root().Size() == values.size());
+        for (std::size_t i = 0; i < values.size(); ++i)
+            REQUIRE(document.Root()[i].Float() == values[i]);
+    }
+
+    SECTION("Arrays")
+    {
+        std::vector<int> ints;
+        for (int i = -1500; i < 1500; ++i)
+            ints.push_back(i * 7919);
+        const std::array<float, 3> floats = {0.5f, -2.0f, 3.25f};
+
+        auto write = [&](auto& writer, bool batch) {
+            writer.StartObject();
+            writer.Key("ints");
+            if (batch)
+            {
+                writer.IntArray(std::span<const int>(ints));
+            }
+            else
+            {
+                writer.StartArray();
+                for (auto i : ints)
+                    writer.Int(i);
+                writer.FinishArray();
+            }
+            writer.Key("floats");
+            if (batch)
+            {
+                writer.FloatArray(floats);
+            }
+            else
+            {
+                writer.StartArray();
+                for (auto f : floats)
+                    writer.Float(f);
+                writer.FinishArray();
+            }
+            writer.Key("empty");
+            if (batch)
+            {
+                writer.IntArray(std::vector<std::uint64_t>());
+            }
+            else
+            {
+                writer.StartArray();
+                writer.FinishArray();
+            }
+            writer.KeyValue("after", 1);
+            writer.FinishObject();
+        };
+
+        std::string batched, expected, pretty_batched, pretty_expected;
+        {
+            Writer batched_writer{batched};
+            Writer expected_writer{expected};
+            write(batched_writer, true);
+            write(expected_writer, false);
+
+            PrettyWriter pretty_batched_writer{pretty_batched};
+            PrettyWriter pretty_expected_writer{pretty_expected};
+            write(pretty_batched_writer, true);
+            write(pretty_expected_writer, false);
+        }
+        REQUIRE(batched == expected);
+        REQUIRE(pretty_batched == pretty_expected);
+        REQUIRE(batched.starts_with(R"({"ints":[-11878500,-11870581,)"));
+        REQUIRE(batched.ends_with(R"("floats":[0.5,-2.0,3.25],"empty":[],"after":1})"));
+
+        std::ostringstream stream;
+        {
+            Writer writer{stream, 16};
+            write(writer, true);
+        }
+        REQUIRE(stream.str() == expected);
+    }
+}
+
+class CountingErrorHandler : public TestHandler
+{
+public:
+    void Error(std::string&& msg) { errors.push_back(std::move(msg)); }
+
+    std::vector<std::string> errors;
+};
+
+static std::string ReadFile(const std::filesystem::path& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), {}};
+}
+
+TEST_CASE("JSONTestSuite conformance")
+{
+    for (const auto& entry : std::filesystem::directory_iterator(
+             SAXY_JSON_TEST_FILES "/test_parsing"))
+    {
+        auto name = entry.path().filename().string();
+        if (name[0] == 'i')
+            continue;
+
+        INFO(name);
+        auto json = ReadFile(entry.path());
+
+        TestHandler handler;
+        std::istringstream input(json);
+        TestHandler buffer_handler;
+        CountingErrorHandler push_handler;
+        PushParser push_parser{push_handler};
+        auto half = std::string_view(json).substr(0, json.size() / 2);
+        push_parser.Feed(half);
+        push_parser.Feed(std::string_view(json).substr(half.size()));
+        if (name[0] == 'y')
+        {
+            REQUIRE_NOTHROW(Parse(handler, input));
+            REQUIRE_NOTHROW(Parse(buffer_handler, std::string_view(json)));
+            REQUIRE(push_parser.Finish());
+        }
+        else
+        {
+            REQUIRE_THROWS(Parse(handler, input));
+            REQUIRE_THROWS(Parse(buffer_handler, std::string_view(json)));
+            REQUIRE_FALSE(push_parser.Finish());
+        }
+    }
+}
+
+TEST_CASE("Projection")
+{
+    std::string json = R"({
+        "skipped": {"a": [1, 2, {"b": "]}\"["}], "c": "x\\"},
+        "user": {"name": "n\u0041me", "id": 42, "tags": ["a", "b"]},
+        "events": [
+            {"ts": 1.5, "data": [[], {}]},
+            {"type": "x"},
+            {"data": "{[", "ts": 2}
+        ],
+        "list": [10, 20, 30]
+    })";
+
+    auto events = [&](const Projection& projection) {
+        TestHandler buffer_handler;
+        ParseProjected(buffer_handler, std::string_view(json), projection);
+        TestHandler stream_handler;
+        std::istringstream input(json);
+        ParseProjected(stream_handler, input, projection);
+        REQUIRE(buffer_handler.events == stream_handler.events);
+        return buffer_handler.events;
+    };
+
+    REQUIRE(events({"/user/id", "/events/*/ts"}) == std::vector<std::string>{
+        "StartObject", "Key:user", "StartObject", "Key:id", "Int:42", "FinishObject",
+        "Key:events", "StartArray",
+        "StartObject", "Key:ts", "Float:1.500000", "FinishObject",
+        "StartObject", "FinishObject",
+        "StartObject", "Key:ts", "Int:2", "FinishObject",
+        "FinishArray", "FinishObject"});
+
+    REQUIRE(events({"/list/1", "/user/tags"}) == std::vector<std::string>{
+        "StartObject", "Key:user", "StartObject", "Key:tags", "StartArray",
+        "String:a", "String:b", "FinishArray", "FinishObject",
+        "Key:list", "StartArray", "Int:20", "FinishArray", "FinishObject"});
+
+    // Named members also get what the wildcard selects
+    REQUIRE(events({"/events/*/ts", "/events/2/data"}) == std::vector<std::string>{
+        "StartObject", "Key:events", "StartArray",
+        "StartObject", "Key:ts", "Float:1.500000", "FinishObject",
+        "StartObject", "FinishObject",
+        "StartObject", "Key:data", "String:{[", "Key:ts", "Int:2", "FinishObject",
+        "FinishArray", "FinishObject"});
+
+    TestHandler whole;
+    Parse(whole, std::string_view(json));
+    REQUIRE(events({""}) == whole.events);
+    REQUIRE(events({"/missing"}) == std::vector<std::string>{"StartObject", "FinishObject"});
+
+    REQUIRE_THROWS_AS(Projection{"user"}, std::invalid_argument);
+    REQUIRE_THROWS_AS(Projection{"/a~2"}, std::invalid_argument);
+
+    for (auto invalid : {R"({"a": "unterminated})", R"({"a": [1, 2})", R"({"a": 1} x)", R"({"a" 1})"})
+    {
+        INFO(invalid);
+        CountingErrorHandler handler;
+        ParseProjected(handler, std::string_view(invalid), Projection{"/b"});
+        REQUIRE(handler.errors.size() == 1);
+    }
+}
+
+/// Skips arrays and the value of "skip", and stops at "stop" or the number 99
+class ControlHandler : public CountingErrorHandler
+{
+public:
+    Control StartArray()
+    {
+        events.push_back("StartArray");
+        return skip_arrays ? Control::Skip : Control::Continue;
+    }
+    Control Key(std::string&& key)
+    {
+        events.push_back("Key:" + key);
+        if (key == "skip")
+            return Control::Skip;
+        return key == "stop" ? Control::Stop : Control::Continue;
+    }
+    Control Int(std::intmax_t i)
+    {
+        events.push_back("Int:" + std::to_string(i));
+        return i == 99 ? Control::Stop : Control::Continue;
+    }
+
+    bool skip_arrays = true;
+};
+
+TEST_CASE("Handler control codes")
+{
+    std::string json = R"({"a": 1, "skip": {"x": [1, "]\"}"]}, "arr": [1, [2], "}"],)"
+                       R"( "b": {"c": true, "skip": 2}, "stop": 5, "after": 1})";
+    std::vector<std::string> expected = {
+        "StartObject", "Key:a", "Int:1", "Key:skip", "Key:arr", "StartArray",
+        "Key:b", "StartObject", "Key:c", "Bool:1", "Key:skip", "FinishObject",
+        "Key:stop"};
+
+    auto check = [&](auto&& parse) {
+        ControlHandler handler;
+        parse(handler);
+        REQUIRE(handler.errors.empty());
+        REQUIRE(handler.events == expected);
+    };
+
+    check([&](auto& handler) {
+        std::istringstream input(json);
+        Parse(handler, input);
+    });
+    check([&](auto& handler) { Parse(handler, std::string_view(json)); });
+    check([&](auto& handler) {
+        ParseProjected(handler, std::string_view(json), Projection{"/*"});
+    });
+    check([&](auto& handler) {
+        PushParser parser{handler};
+        for (std::size_t i = 0; i < json.size() && parser.Feed(std::string_view(json).substr(i, 1)); ++i)
+            ;
+        REQUIRE_FALSE(parser.Feed(std::string_view("garbage")));
+        REQUIRE(parser.Finish());
+    });
+    check([&](auto& handler) { ParseLines(handler, json + "\n[1]"); });
+
+    // Stopping is not an error, even if the rest of the input is invalid
+    expected = {"StartArray", "Int:1", "Int:99"};
+    check([&](auto& handler) {
+        handler.skip_arrays = false;
+        Parse(handler, std::string_view("[1, 99, 3"));
+    });
+}
+
+class InternedHandler : public TestHandler
+{
+public:
+    void Key(InternedKey key)
+    {
+        REQUIRE(key.hash == KeyHash(key.view));
+        ids.push_back(key.id);
+        events.push_back("Key:" + std::string(key.view));
+    }
+
+    std::vector<std::uint32_t> ids;
+};
+
+TEST_CASE("Handler references")
+{
+    std::string json = R"({"a": [1, 2.5, "s\"", true, null], "b": {}})";
+    TestHandler expected;
+    Parse(expected, std::string_view(json));
+
+    TestHandler handler;
+    HandlerRef ref{handler};
+    Parse(ref, std::string_view(json));
+    REQUIRE(handler.events == expected.events);
+
+    TestHandler stream_handler;
+    HandlerRef stream_ref{stream_handler};
+    std::istringstream input(json);
+    Parse(stream_ref, input);
+    REQUIRE(stream_handler.events == expected.events);
+
+    // Control codes and errors are passed through
+    ControlHandler control;
+    HandlerRef control_ref{control};
+    Parse(control_ref, std::string_view(R"({"skip": [1], "x": 99, "y": 1})"));
+    REQUIRE(control.events == std::vector<std::string>{"StartObject", "Key:skip", "Key:x", "Int:99"});
+    REQUIRE(Parse(control_ref, std::string_view("[1,")).code == ErrorCode::UnexpectedEof);
+    REQUIRE(control.errors.size() == 1);
+
+    // Optional number callbacks are forwarded only if the handler declares
+    // them
+    UintHandler uints;
+    HandlerRef uint_ref{uints};
+    REQUIRE(Parse(uint_ref, std::string_view("[18446744073709551615, 1]")));
+    REQUIRE(uints.uints == std::vector<std::uint64_t>{18446744073709551615u});
+    REQUIRE(uints.ints == std::vector<std::intmax_t>{1});
+    NumberHandler ints;
+    HandlerRef int_ref{ints};
+    REQUIRE_THROWS(Parse(int_ref, std::string_view("[18446744073709551615]")));
+
+    std::string raw;
+    {
+        Writer writer{raw};
+        PassThroughHandler pass_through{writer};
+        HandlerRef raw_ref{pass_through};
+        REQUIRE(Parse(raw_ref, std::string_view("[1e400, -0.0, 100000000000000000000000]")));
+        std::istringstream raw_input("[1.50]");
+        REQUIRE(Parse(raw_ref, raw_input));
+    }
+    REQUIRE(raw == "[1e400,-0.0,100000000000000000000000],[1.50]");
+
+    // Keys are interned if the handler takes them as InternedKey
+    KeyTable keys;
+    keys.Intern("b");
+    InternedHandler interned;
+    HandlerRef interned_ref{interned};
+    REQUIRE(Parse(interned_ref, std::string_view(json), {.keys = &keys}));
+    REQUIRE(interned.events == expected.events);
+    REQUIRE(interned.ids == std::vector<std::uint32_t>{1, 0});
+    std::istringstream interned_input(json);
+    REQUIRE(Parse(interned_ref, interned_input));
+    REQUIRE(interned.ids == std::vector<std::uint32_t>{1, 0, KeyTable::none, KeyTable::none});
+
+    // A hand-written table with a context per parse, used concurrently
+    static constexpr HandlerRef::VTable counting = {
+        [](void*) { return Control::Continue; },
+        [](void*) { return Control::Continue; },
+        [](void*) { return Control::Continue; },
+        [](void*) { return Control::Continue; },
+        [](void*, std::string_view) { return Control::Continue; },
+        [](void*, std::string_view) { return Control::Continue; },
+        [](void*, bool) { return Control::Continue; },
+        [](void* context, std::intmax_t val) {
+            *static_cast<std::intmax_t*>(context) += val;
+            return Control::Continue;
+        },
+        [](void*, double) { return Control::Continue; },
+        [](void*) { return Control::Continue; },
+        nullptr,
+    };
+    std::string numbers = "[";
+    for (int i = 1; i <= 1000; ++i)
+        numbers += std::to_string(i) + (i < 1000 ? "," : "]");
+
+    std::array<std::intmax_t, 4> sums{};
+    std::vector<std::thread> threads;
+    for (auto& sum : sums)
+        threads.emplace_back([&numbers, &sum] {
+            HandlerRef sum_ref{&sum, counting};
+            Parse(sum_ref, std::string_view(numbers));
+        });
+    for (auto& thread : threads)
+        thread.join();
+    for (auto sum : sums)
+        REQUIRE(sum == 500500);
+    HandlerRef sum_ref{&sums[0], counting};
+    REQUIRE_FALSE(Parse(sum_ref, std::string_view("[")));
+}
+
+TEST_CASE("Nesting depth")
+{
+    std::string deep(100000, '[');
+
+    CountingErrorHandler handler;
+    Parse(handler, std::string_view(deep));
+    REQUIRE(handler.errors.size() == 1);
+    REQUIRE(handler.events.size() == ParseOptions{}.max_depth);
+
+    std::string nested = "[[[[1]]]]";
+    CountingErrorHandler limited;
+    Parse(limited, std::string_view(nested), {.max_depth = 3});
+    REQUIRE(limited.errors.size() == 1);
+
+    CountingErrorHandler unlimited;
+    std::istringstream input(nested);
+    Parse(unlimited, input, {.max_depth = 4});
+    REQUIRE(unlimited.errors.empty());
+    REQUIRE(unlimited.events.size() == 9);
+}
+
+TEST_CASE("Parsing stops at the first error")
+{
+    CountingErrorHandler handler;
+    Parse(handler, std::string_view(R"([1, 2 3, {"a" 4}, "unterminated)"));
+    REQUIRE(handler.errors.size() == 1);
+    std::vector<std::string> expected = {"StartArray", "Int:1", "Int:2"};
+    REQUIRE(handler.events == expected);
+}
+
+/// Handler without an Error callback, whose errors are only returned
+struct SilentHandler
+{
+    void StartObject() {}
+    void FinishObject() {}
+    void StartArray() {}
+    void FinishArray() {}
+    void Key(std::string_view) {}
+    void String(std::string_view) {}
+    void Int(std::intmax_t) {}
+    void Float(double) {}
+    void Bool(bool) {}
+    void Null() {}
+};
+
+TEST_CASE("Error results")
+{
+    std::string json = "{\n  \"a\": [1, 2],\n  \"b\": tru\n}";
+
+    SilentHandler handler;
+    auto result = Parse(handler, std::string_view(json));
+    REQUIRE_FALSE(result);
+    REQUIRE(result.code == ErrorCode::UnexpectedCharacter);
+    REQUIRE(result.character == '\n');
+    REQUIRE(result.offset == json.find("tru") + 3);
+    REQUIRE(result.line == 3);
+    REQUIRE(result.column == 11);
+
+    std::istringstream input(json);
+    auto stream_result = Parse(handler, input);
+    REQUIRE(stream_result.code == result.code);
+    REQUIRE(stream_result.offset == result.offset);
+    REQUIRE(stream_result.line == result.line);
+    REQUIRE(stream_result.column == result.column);
+
+    PushParser parser{handler};
+    for (char c : json)
+        parser.Feed({&c, 1});
+    REQUIRE(parser.Result().code == result.code);
+    REQUIRE(parser.Result().character == result.character);
+    REQUIRE(parser.Result().offset == result.offset);
+    REQUIRE(parser.Result().line == result.line);
+    REQUIRE(parser.Result().column == result.column);
+
+    // Every parser reports the same error, wherever the input is split
+    for (std::string_view invalid :
+         {"[nul]", "[tru]", "[fals,1]", "t,ue", "{\"a\": nu}", "1-5", "truex",
+          "[1-5]", "[-]", "0 1", "[1e400,1]", "{\"a\": 100000000000000000000000}"})
+    {
+        INFO(invalid);
+        auto expected = Parse(handler, invalid);
+        REQUIRE_FALSE(expected);
+
+        std::istringstream invalid_input{std::string(invalid)};
+        auto from_stream = Parse(handler, invalid_input);
+        REQUIRE(from_stream.code == expected.code);
+        REQUIRE(from_stream.character == expected.character);
+        REQUIRE(from_stream.offset == expected.offset);
+
+        for (std::size_t split = 0; split <= invalid.size(); ++split)
+        {
+            PushParser push_parser{handler};
+            if (push_parser.Feed(invalid.substr(0, split))
+                && push_parser.Feed(invalid.substr(split)))
+                push_parser.Finish();
+            REQUIRE(push_parser.Result().code == expected.code);
+            REQUIRE(push_parser.Result().character == expected.character);
+            REQUIRE(push_parser.Result().offset == expected.offset);
+        }
+    }
+    REQUIRE(Parse(handler, std::string_view("1-5")).code == ErrorCode::TrailingCharacters);
+
+    REQUIRE(Parse(handler, std::string_view(R"({"a": [1, 2]})")));
+    REQUIRE(Parse(handler, std::string_view("[1, 2] 3")).code == ErrorCode::TrailingCharacters);
+    REQUIRE(Parse(handler, std::string_view("[1, 2")).code == ErrorCode::UnexpectedEof);
+    REQUIRE(Parse(handler, std::string_view("[01]")).code == ErrorCode::InvalidNumber);
+    REQUIRE(Parse(handler, std::string_view(R"("\x")")).code == ErrorCode::InvalidEscape);
+    REQUIRE(Parse(handler, std::string_view("[\"\t\"]")).code == ErrorCode::ControlCharacter);
+    REQUIRE(Parse(handler, std::string_view("1" + std::string(30, '0'))).code
+            == ErrorCode::NumberOutOfRange);
+
+    CountingErrorHandler counting;
+    result = Parse(counting, std::string_view("[1,\n x]"));
+    REQUIRE(result.Message() == "Unexpected character 'x' at line 2, column 2");
+    REQUIRE(counting.errors == std::vector<std::string>{result.Message()});
+}
+
+TEST_CASE("Unicode escapes")
+{
+    auto decode = [](std::string_view json) {
+        TestHandler handler;
+        REQUIRE(Parse(handler, json));
+
+        std::istringstream stream{std::string(json)};
+        TestHandler stream_handler;
+        REQUIRE(Parse(stream_handler, stream));
+        REQUIRE(stream_handler.events == handler.events);
+
+        REQUIRE(handler.events.size() == 1);
+        return handler.events[0].substr(std::string_view("String:").size());
+    };
+
+    REQUIRE(decode(R"("\u0041\u0062c")") == "Abc");
+    REQUIRE(decode(R"("\u0000")") == std::string(1, '\0'));
+    REQUIRE(decode(R"("caf\u00e9 \u00E9")") == "caf\xc3\xa9 \xc3\xa9");
+    REQUIRE(decode(R"("\u07ff\u0800")") == "\xdf\xbf\xe0\xa0\x80");
+    REQUIRE(decode(R"("\u65e5\u672c")") == "\xe6\x97\xa5\xe6\x9c\xac");
+    REQUIRE(decode(R"("\uFFFF")") == "\xef\xbf\xbf");
+    REQUIRE(decode(R"("\ud83d\ude00!")") == "\xf0\x9f\x98\x80!");
+    REQUIRE(decode(R"("\uDBFF\uDFFF")") == "\xf4\x8f\xbf\xbf");
+    REQUIRE(decode(R"("\u0022\u005C")") == "\"\\");
+
+    auto error = [](std::string_view json) {
+        TestHandler handler;
+        REQUIRE_THROWS(Parse(handler, json));
+        SilentHandler silent;
+        return Parse(silent, json).code;
+    };
+    REQUIRE(error(R"("\u12G4")") == ErrorCode::InvalidUnicodeEscape);
+    REQUIRE(error(R"("\u12")") == ErrorCode::InvalidUnicodeEscape);
+    REQUIRE(error(R"("\u12)") == ErrorCode::UnexpectedEof);
+    REQUIRE(error(R"("\ude00")") == ErrorCode::UnpairedSurrogate);
+    REQUIRE(error(R"("\ud83d")") == ErrorCode::UnpairedSurrogate);
+    REQUIRE(error(R"("\ud83dx")") == ErrorCode::UnpairedSurrogate);
+    REQUIRE(error(R"("\ud83d\n")") == ErrorCode::UnpairedSurrogate);
+    REQUIRE(error(R"("\ud83d\ud83d")") == ErrorCode::UnpairedSurrogate);
+    REQUIRE(error(R"("\ud83d\u12)") == ErrorCode::UnexpectedEof);
+    REQUIRE(error(R"("\ud83d)") == ErrorCode::UnexpectedEof);
+}
+
+TEST_CASE("UTF-8 validation")
+{
+    ParseOptions options{.validate_utf8 = true};
+
+    auto parse = [&](std::string_view json) {
+        SilentHandler handler;
+        auto result = Parse(handler, json, options);
+
+        std::istringstream input{std::string(json)};
+        auto stream_result = Parse(handler, input, options);
+        REQUIRE(stream_result.code == result.code);
+        REQUIRE(stream_result.offset == result.offset);
+
+        PushParser push_parser{handler, options};
+        push_parser.Feed(json.substr(0, json.size() / 2));
+        push_parser.Feed(json.substr(json.size() / 2));
+        REQUIRE(push_parser.Finish() == bool(result));
+        if (!result)
+            REQUIRE(push_parser.Result().offset == result.offset);
+        return result;
+    };
+
+    SECTION("Valid")
+    {
+        std::string text;
+        for (int i = 0; i < 40; ++i)
+            text += std::string(static_cast<std::size_t>(i % 7), 'a')
+                + "\xc3\xa9\xe6\x97\xa5\xf0\x9f\x98\x80\xef\xbf\xbf\xf4\x8f\xbf\xbf";
+        auto json = R"({")" + text + R"(": [")" + text + R"(\n)" + text + R"("]})";
+        REQUIRE(parse(json));
+
+        TestHandler handler;
+        Parse(handler, json, options);
+        REQUIRE(handler.events[1] == "Key:" + text);
+        REQUIRE(handler.events[3] == "String:" + text + "\n" + text);
+    }
+
+    SECTION("Invalid")
+    {
+        struct Case
+        {
+            std::string_view json;
+            std::size_t offset;
+        };
+        const Case cases[] = {
+            {"\"\xff\"", 1},
+            {"\"\x80\"", 1},
+            {"[\"ab\xc3\"]", 5},
+            {"\"\xc0\xaf\"", 1},
+            {"\"\xe0\x80\x80\"", 2},
+            {"\"\xed\xa0\x80\"", 2},
+            {"\"\xf4\x90\x80\x80\"", 2},
+            {"\"\xf0\x9f\x98\"", 4},
+            {"\"ok\xe6\x97\xa5\\n\xe6\x97\"", 10},
+            {"{\"\xe9t\xe9\": 1}", 3},
+        };
+        for (auto [json, offset] : cases)
+        {
+            INFO(json);
+            SilentHandler handler;
+            REQUIRE(Parse(handler, json));
+
+            auto result = parse(json);
+            REQUIRE(result.code == ErrorCode::InvalidUtf8);
+            REQUIRE(result.offset == offset);
         }
+        REQUIRE(parse("\"\xe6\x97").code == ErrorCode::UnexpectedEof);
     }
+
+    SECTION("JSONTestSuite")
+    {
+        for (const auto& entry : std::filesystem::directory_iterator(
+                 SAXY_JSON_TEST_FILES "/test_parsing"))
+        {
+            auto name = entry.path().filename().string();
+            if (!name.starts_with("y_") && !name.starts_with("i_string"))
+                continue;
+
+            INFO(name);
+            REQUIRE(bool(parse(ReadFile(entry.path()))) == (name[0] == 'y'));
+        }
+    }
+}
+
+TEST_CASE("Push parser")
+{
+    std::string json =
+        R"({"key": "va\"lue", "numbers": [1, -23, 4.5e6, 0], )"
+        R"("literals": [true, false, null], "empty": {}, "nested": [[], {"a": "A"}]})";
+
+    TestHandler expected;
+    Parse(expected, std::string_view(json));
+
+    SECTION("Split at every position")
+    {
+        for (std::size_t split = 0; split <= json.size(); ++split)
+        {
+            TestHandler handler;
+            PushParser parser{handler};
+            REQUIRE(parser.Feed(std::string_view(json).substr(0, split)));
+            REQUIRE(parser.Feed(std::string_view(json).substr(split)));
+            REQUIRE(parser.Finish());
+            REQUIRE(handler.events == expected.events);
+        }
+    }
+
+    SECTION("One byte at a time")
+    {
+        ViewHandler handler;
+        PushParser parser{handler};
+        for (char c : json)
+            REQUIRE(parser.Feed(std::span<const char>(&c, 1)));
+        REQUIRE(parser.Finish());
+        REQUIRE(handler.events == expected.events);
+    }
+
+    SECTION("Numbers at the end of the input")
+    {
+        TestHandler handler;
+        PushParser parser{handler};
+        REQUIRE(parser.Feed(std::string_view("12")));
+        REQUIRE(parser.Feed(std::string_view("34")));
+        REQUIRE(parser.Finish());
+        REQUIRE(handler.events == std::vector<std::string>{"Int:1234"});
+    }
+
+    SECTION("Invalid")
+    {
+        std::vector<std::string> tests = {
+            R"({"a" 1})", R"([1 2])",  R"([1,])",   R"({"a": tru})",
+            R"([1.2.3])", R"("abc)",   R"([1] 2)", R"({"a": 1)",
+            R"(nul)",     R"([01])",   R"([-])",   R"({"a": "b\x"})",
+        };
+
+        for (const auto& test : tests)
+        {
+            INFO(test);
+            for (std::size_t split = 0; split <= test.size(); ++split)
+            {
+                CountingErrorHandler handler;
+                PushParser parser{handler};
+                parser.Feed(std::string_view(test).substr(0, split));
+                parser.Feed(std::string_view(test).substr(split));
+                REQUIRE_FALSE(parser.Finish());
+                REQUIRE(handler.errors.size() == 1);
+            }
+        }
+    }
+}
+
+TEST_CASE("ParseFile")
+{
+    auto dir = std::filesystem::temp_directory_path();
+    std::string json = R"({"file": [1, 2.5, "three", true, null]})";
+    TestHandler expected;
+    Parse(expected, std::string_view(json));
+
+    SECTION("Regular file")
+    {
+        auto path = dir / "saxy-json-test.json";
+        std::ofstream(path, std::ios::binary) << json;
+
+        TestHandler handler;
+        ParseFile(handler, path);
+        REQUIRE(handler.events == expected.events);
+        std::filesystem::remove(path);
+    }
+
+    SECTION("Empty file")
+    {
+        auto path = dir / "saxy-json-empty.json";
+        std::ofstream(path, std::ios::binary).flush();
+
+        CountingErrorHandler handler;
+        ParseFile(handler, path);
+        REQUIRE(handler.errors.size() == 1);
+        std::filesystem::remove(path);
+    }
+
+    SECTION("Missing file")
+    {
+        CountingErrorHandler handler;
+        ParseFile(handler, dir / "saxy-json-does-not-exist.json");
+        REQUIRE(handler.errors.size() == 1);
+        REQUIRE(handler.events.empty());
+    }
+
+#ifdef SAXY_JSON_POSIX
+    SECTION("Pipe")
+    {
+        auto path = dir / "saxy-json-test.fifo";
+        std::filesystem::remove(path);
+        REQUIRE(::mkfifo(path.c_str(), 0600) == 0);
+
+        std::thread writer([&path, &json] {
+            std::ofstream(path, std::ios::binary) << json;
+        });
+        TestHandler handler;
+        ParseFile(handler, path);
+        writer.join();
+        REQUIRE(handler.events == expected.events);
+        std::filesystem::remove(path);
+    }
+#endif
+}
+
+class RecordHandler : public CountingErrorHandler
+{
+public:
+    void StartRecord() { events.push_back("StartRecord"); }
+    void FinishRecord() { events.push_back("FinishRecord"); }
+    void Error(std::string&& msg)
+    {
+        events.push_back("Error");
+        CountingErrorHandler::Error(std::move(msg));
+    }
+};
+
+TEST_CASE("JSON Lines")
+{
+    std::string lines = "{\"a\": 1}\n"
+                        "\n"
+                        "[1, 2\n"
+                        "\"two\" 3\r\n"
+                        "{\"b\": tru}  \"after error\"\n"
+                        "null";
+
+    std::vector<std::string> expected = {
+        "StartRecord", "StartObject",  "Key:a",        "Int:1",
+        "FinishObject", "FinishRecord", "StartRecord",  "StartArray",
+        "Int:1",        "Int:2",        "Error",        "StartRecord",
+        "String:two",   "FinishRecord", "StartRecord",  "Int:3",
+        "FinishRecord", "StartRecord",  "StartObject",  "Key:b",
+        "Error",        "StartRecord",  "Null",         "FinishRecord",
+    };
+
+    RecordHandler handler;
+    ParseLines(handler, std::string_view(lines));
+    REQUIRE(handler.events == expected);
+    std::vector<std::string> errors = {
+        "Unexpected EOF at line 3, column 6",
+        "Unexpected character '}' at line 5, column 10",
+    };
+    REQUIRE(handler.errors == errors);
+
+    RecordHandler stream_handler;
+    std::istringstream input(lines);
+    ParseLines(stream_handler, input);
+    REQUIRE(stream_handler.events == expected);
+    REQUIRE(stream_handler.errors == errors);
+}
+
+TEST_CASE("Parallel JSON Lines")
+{
+    std::string lines;
+    for (int i = 0; i < 1000; ++i)
+        lines += R"({"id": )" + std::to_string(i) + R"(, "tags": ["a", "b"]})" + "\n";
+    lines += "{broken\n[1]";
+
+    RecordHandler serial;
+    ParseLines(serial, std::string_view(lines));
+
+    for (auto delivery : {Delivery::Ordered, Delivery::Unordered})
+    {
+        std::vector<std::pair<std::size_t, RecordHandler>> chunks;
+        ParseLinesParallel(
+            RecordHandler{}, lines,
+            [&chunks](RecordHandler&& handler, std::size_t index) {
+                chunks.emplace_back(index, std::move(handler));
+            },
+            {.threads = 4, .chunk_size = 512, .delivery = delivery});
+
+        REQUIRE(chunks.size() > 4);
+        if (delivery == Delivery::Unordered)
+            std::sort(chunks.begin(), chunks.end(), [](auto& a, auto& b) {
+                return a.first < b.first;
+            });
+
+        std::vector<std::string> events;
+        std::vector<std::string> errors;
+        for (std::size_t i = 0; i < chunks.size(); ++i)
+        {
+            REQUIRE(chunks[i].first == i);
+            auto& handler = chunks[i].second;
+            events.insert(events.end(), handler.events.begin(), handler.events.end());
+            errors.insert(errors.end(), handler.errors.begin(), handler.errors.end());
+        }
+        REQUIRE(events == serial.events);
+        REQUIRE(errors == std::vector<std::string>{
+                    "Unexpected character 'b' at offset " + std::to_string(lines.find("broken"))});
+    }
+
+    REQUIRE_THROWS(ParseLinesParallel(
+        TestHandler{}, lines, [](TestHandler&&, std::size_t) {},
+        {.threads = 4, .chunk_size = 512}));
+}
+
+TEST_CASE("Document")
+{
+    std::string json = R"({
+        "name": "saxy", "escaped": "a\"b", "version": 3, "ratio": 0.5,
+        "tags": ["fast", "small", []], "nested": {"a": {"b": [null, true]}},
+        "empty": {}, "dup": 1, "dup": 2
+    })";
+
+    Document doc;
+    REQUIRE(doc.ParseBorrowed(json));
+    auto& root = doc.Root();
+    REQUIRE(root.IsObject());
+    REQUIRE(root.Size() == 9);
+    REQUIRE(root["name"].String() == "saxy");
+    REQUIRE(root["escaped"].String() == "a\"b");
+    REQUIRE(root["version"].Int() == 3);
+    REQUIRE(root["version"].Float() == 3.0);
+    REQUIRE(root["ratio"].Float() == 0.5);
+    REQUIRE(root["tags"].Size() == 3);
+    REQUIRE(root["tags"][1].String() == "small");
+    REQUIRE(root["tags"][2].IsArray());
+    REQUIRE(root["nested"]["a"]["b"][0].IsNull());
+    REQUIRE(root["nested"]["a"]["b"][1].Bool());
+    REQUIRE(root["empty"].Members().empty());
+    REQUIRE(root["dup"].Int() == 1);
+    REQUIRE(root.Find("missing") == nullptr);
+    REQUIRE(root["tags"].Find("name") == nullptr);
+
+    // Members keep their order, and unescaped strings point into the input
+    std::vector<std::string_view> keys;
+    for (auto& member : root.Members())
+        keys.push_back(member.key);
+    REQUIRE(keys == std::vector<std::string_view>{
+                "name", "escaped", "version", "ratio", "tags", "nested", "empty", "dup", "dup"});
+    REQUIRE(root["name"].String().data() == json.data() + json.find("saxy"));
+
+    REQUIRE_THROWS_AS(root["missing"], std::out_of_range);
+    REQUIRE_THROWS_AS(root["tags"][3], std::out_of_range);
+    REQUIRE_THROWS_AS(root["name"].Int(), std::invalid_argument);
+    REQUIRE_THROWS_AS(root[0], std::invalid_argument);
+
+    // Large objects are looked up through a sorted index
+    std::string large = "{";
+    for (int i = 0; i < 100; ++i)
+        large += "\"k" + std::to_string(i) + "\": " + std::to_string(i) + ", ";
+    large += R"("k7": "duplicate"})";
+    REQUIRE(doc.Parse(large));
+    REQUIRE(doc.Root().Size() == 101);
+    for (int i = 0; i < 100; ++i)
+        REQUIRE(doc.Root()["k" + std::to_string(i)].Int() == i);
+    REQUIRE(doc.Root().Find("k100") == nullptr);
+    REQUIRE(doc.Root().Find("") == nullptr);
+
+    // Copied strings stay valid without the input
+    std::string copied = R"(["short", "a somewhat longer string value"])";
+    REQUIRE(doc.Parse(copied));
+    copied.assign(copied.size(), 'x');
+    REQUIRE(doc.Root()[1].String() == "a somewhat longer string value");
+
+    std::istringstream input(json);
+    Document moved;
+    REQUIRE(moved.Parse(input));
+    doc = std::move(moved);
+    REQUIRE(doc.Root()["nested"]["a"]["b"].Size() == 2);
+
+    REQUIRE(doc.Parse(std::string_view("42")));
+    REQUIRE(doc.Root().Int() == 42);
+
+    REQUIRE(doc.Parse(std::string_view(R"({"a": [1, 2)")).code == ErrorCode::UnexpectedEof);
+    REQUIRE(doc.Root().IsNull());
+    REQUIRE(doc.Parse(std::string_view(R"({"a": [1, 2]})")));
+    REQUIRE(doc.Root()["a"][1].Int() == 2);
+}
+
+namespace bound
+{
+struct Address
+{
+    std::string city;
+    int zip = 0;
+};
+SAXY_JSON_FIELDS(Address, city, zip)
+
+struct Person
+{
+    std::string name;
+    std::uint8_t age = 0;
+    double height = 0;
+    bool active = false;
+    Address address;
+    std::vector<Address> previous;
+    std::vector<std::vector<int>> matrix;
+    std::optional<std::string> nickname;
+};
+SAXY_JSON_FIELDS(Person, name, age, height, active, address, previous, matrix, nickname)
+
+struct Counter
+{
+    std::uint64_t count = 0;
+    std::optional<double> total;
+};
+SAXY_JSON_FIELDS(Counter, count, total)
+
+struct Tree
+{
+    int value = 0;
+    std::vector<Tree> children;
+    std::optional<Address> home;
+};
+SAXY_JSON_FIELDS(Tree, value, children, home)
+} // namespace bound
+
+TEST_CASE("Struct binding")
+{
+    std::string json = R"({
+        "name": "Ada", "age": 36, "height": 1, "active": true, "unknown": {"x": [1]},
+        "address": {"city": "London", "zip": 1815},
+        "previous": [{"city": "Paris"}, {"zip": 7, "city": "Rome"}],
+        "matrix": [[1, 2], [], [3]], "nickname": null
+    })";
+
+    bound::Person person;
+    person.nickname = "old";
+    REQUIRE(ParseInto(person, std::string_view(json)));
+    REQUIRE(person.name == "Ada");
+    REQUIRE(person.age == 36);
+    REQUIRE(person.height == 1.0);
+    REQUIRE(person.active);
+    REQUIRE(person.address.city == "London");
+    REQUIRE(person.address.zip == 1815);
+    REQUIRE(person.previous.size() == 2);
+    REQUIRE(person.previous[0].city == "Paris");
+    REQUIRE(person.previous[1].zip == 7);
+    REQUIRE(person.matrix == std::vector<std::vector<int>>{{1, 2}, {}, {3}});
+    REQUIRE_FALSE(person.nickname);
+
+    // Writing and parsing again gives the same object
+    std::string written;
+    Writer writer(written);
+    person.nickname = "Countess";
+    Write(writer, person);
+    REQUIRE(written == R"({"name":"Ada","age":36,"height":1.0,"active":true,)"
+                       R"("address":{"city":"London","zip":1815},)"
+                       R"("previous":[{"city":"Paris","zip":0},{"city":"Rome","zip":7}],)"
+                       R"("matrix":[[1,2],[],[3]],"nickname":"Countess"})");
+    bound::Person copy;
+    std::istringstream input(written);
+    REQUIRE(ParseInto(copy, input));
+    REQUIRE(copy.previous[1].city == "Rome");
+    REQUIRE(copy.nickname == "Countess");
+
+    std::vector<bound::Address> addresses;
+    REQUIRE(ParseInto(addresses, std::string_view(R"([{"city": "Oslo"}])")));
+    REQUIRE(addresses.at(0).city == "Oslo");
+
+    for (auto invalid : {R"({"age": 300})", R"({"age": "36"})", R"({"name": 1})",
+                         R"({"address": []})", R"({"matrix": [1]})", R"({"height": null})", "[]"})
+    {
+        INFO(invalid);
+        bound::Person target;
+        auto result = ParseInto(target, std::string_view(invalid));
+        REQUIRE(result.code == ErrorCode::TypeMismatch);
+    }
+    REQUIRE(ParseInto(person, std::string_view(R"({"name": "x)")).code == ErrorCode::UnexpectedEof);
+
+    // Recursive types, and structs in optionals
+    bound::Tree tree;
+    REQUIRE(ParseInto(tree, std::string_view(R"({"value": 1, "children": [
+        {"value": 2, "home": {"city": "Oslo", "zip": 150}},
+        {"children": [{"value": 4, "children": []}], "value": 3}], "home": null})")));
+    REQUIRE(tree.value == 1);
+    REQUIRE(tree.children.size() == 2);
+    REQUIRE(tree.children[0].home->city == "Oslo");
+    REQUIRE(tree.children[0].home->zip == 150);
+    REQUIRE(tree.children[1].value == 3);
+    REQUIRE(tree.children[1].children.at(0).value == 4);
+    REQUIRE_FALSE(tree.children[1].home);
+    REQUIRE_FALSE(tree.home);
+    REQUIRE(ParseInto(tree, std::string_view(R"({"children": [{"home": []}]})")).code
+            == ErrorCode::TypeMismatch);
+
+    // Integers above the range of std::intmax_t
+    bound::Counter counter;
+    REQUIRE(ParseInto(counter,
+        std::string_view(R"({"count": 18446744073709551615, "total": 9223372036854775808})")));
+    REQUIRE(counter.count == std::numeric_limits<std::uint64_t>::max());
+    REQUIRE(counter.total == 9223372036854775808.0);
+    REQUIRE(ParseInto(person, std::string_view(R"({"age": 9223372036854775808})")).code
+            == ErrorCode::TypeMismatch);
+    std::string counted;
+    Writer counter_writer(counted);
+    Write(counter_writer, counter);
+    REQUIRE(counted == R"({"count":18446744073709551615,"total":9223372036854775808.0})");
+
+    static_assert(Bindable<std::int8_t> && Bindable<std::vector<std::uint64_t>>);
+    static_assert(!Bindable<char> && !Bindable<char8_t> && !Bindable<std::vector<wchar_t>>);
+}
+
+TEST_CASE("Key interning")
+{
+    std::string json = R"([{"id": 1, "name": "a"}, {"name": "b", "id": 2, "new": null},)"
+                       R"( {"name": "c"}])";
+    TestHandler expected;
+    Parse(expected, std::string_view(json));
+
+    KeyTable keys;
+    auto id = keys.Intern("id");
+    REQUIRE(id == 0);
+    REQUIRE(keys.Intern("id") == id);
+
+    InternedHandler handler;
+    REQUIRE(Parse(handler, std::string_view(json), {.keys = &keys}));
+    REQUIRE(handler.events == expected.events);
+    REQUIRE(handler.ids == std::vector<std::uint32_t>{0, 1, 1, 0, 2, 1});
+    REQUIRE(keys.Size() == 3);
+    REQUIRE(keys.Key(2) == "new");
+    REQUIRE(keys.Find("name") == 1);
+    REQUIRE(keys.Find("missing") == KeyTable::none);
+
+    // Ids are kept across parses and parsers
+    InternedHandler stream_handler;
+    std::istringstream input(json);
+    REQUIRE(Parse(stream_handler, input, {.keys = &keys}));
+    REQUIRE(stream_handler.ids == handler.ids);
+    InternedHandler push_handler;
+    PushParser parser{push_handler, {.keys = &keys}};
+    for (char c : json)
+        parser.Feed({&c, 1});
+    REQUIRE(parser.Finish());
+    REQUIRE(push_handler.ids == handler.ids);
+    InternedHandler projected_handler;
+    ParseProjected(projected_handler, std::string_view(json), {"/*/id"}, {.keys = &keys});
+    REQUIRE(projected_handler.ids == std::vector<std::uint32_t>{0, 0});
+
+    // A full table passes new keys without id, and no table only hashes
+    KeyTable small(2);
+    InternedHandler limited;
+    Parse(limited, std::string_view(json), {.keys = &small});
+    REQUIRE(limited.ids == std::vector<std::uint32_t>{0, 1, 1, 0, KeyTable::none, 1});
+    KeyTable tiny(10, 4);
+    InternedHandler bytes_limited;
+    Parse(bytes_limited, std::string_view(json), {.keys = &tiny});
+    REQUIRE(bytes_limited.ids == std::vector<std::uint32_t>{0, KeyTable::none, KeyTable::none, 0, KeyTable::none, KeyTable::none});
+    InternedHandler hashed;
+    Parse(hashed, std::string_view(json));
+    REQUIRE(std::all_of(hashed.ids.begin(), hashed.ids.end(), [](auto id) { return id == KeyTable::none; }));
+
+    keys.Clear();
+    REQUIRE(keys.Size() == 0);
+    REQUIRE(keys.Intern("name") == 0);
+
+    static_assert(KeyHash("id") != KeyHash("name"));
+    REQUIRE_THROWS_AS(ParseLinesParallel(TestHandler{}, "1", [](TestHandler&&, std::size_t) {},
+                                         {.parse = {.keys = &keys}}),
+                      std::invalid_argument);
 }